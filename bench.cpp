@@ -0,0 +1,150 @@
+#include "utils.hpp"
+
+#include "frontend/frontend.hpp"
+#include "benchmark/corpus.hpp"
+#include "benchmark/measure.hpp"
+#include "benchmark/stress.hpp"
+
+#include <new>
+
+// every allocation of the process is counted, so the lexers are measured as they are. all
+// forms of new and delete go through these two, so none is counted on another path.
+static void* counted_allocate(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept
+{
+	benchmark::allocation_cnt.fetch_add(1, std::memory_order_relaxed);
+	if (size == 0) size = 1;
+	if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) return std::malloc(size);
+	// aligned_alloc wants a multiple of the alignment
+	return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+static void* counted_allocate_or_throw(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+{
+	if (auto p = counted_allocate(size, alignment)) return p;
+	throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size) { return counted_allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return counted_allocate_or_throw(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return counted_allocate_or_throw(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return counted_allocate_or_throw(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept { return counted_allocate(size); }
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept { return counted_allocate(size); }
+void* operator new(std::size_t size, std::align_val_t al, std::nothrow_t const&) noexcept { return counted_allocate(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, std::nothrow_t const&) noexcept { return counted_allocate(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept { std::free(p); }
+
+// throughput at the full size may not fall under this share of the one at a quarter of it
+inline constexpr double stress_band = 0.5;
+
+// bench stress [size in MiB] [repeat] [min MB/s]
+// lexes every pathological corpus at a quarter of `size` and at `size`, prints one JSON
+// document with both throughputs per corpus and lexer, and fails if any is out of band
+int run_stress(int argc, char** argv)
+{
+	std::size_t size = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16) << 20;
+	std::size_t repeat = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 3;
+	double min_mb_per_s = argc > 4 ? std::strtod(argv[4], nullptr) : 0;
+	if (size == 0 || repeat == 0)
+		panic("usage: bench stress [size in MiB] [repeat] [min MB/s]\n");
+
+	std::vector<frontend::diagnostic_t> diagnostics;
+	auto const scan = [&](std::string_view source) {
+		diagnostics.clear();
+		frontend::scanner_t lex{ "bench", source };
+		lex.diagnostics = &diagnostics;
+		std::size_t n{ 1 };
+		while (lex.next_token().tokenkind != frontend::token_e::L_EOF) ++n;
+		return n;
+	};
+	frontend::token_buffer_t buffer;
+	auto const tokenize = [&](std::string_view source) {
+		diagnostics.clear();
+		frontend::tokenize_all(buffer, source, "bench", {}, &diagnostics);
+		return buffer.size();
+	};
+
+	bool passed = true;
+	println("{\"size\":", size, ",\"repeat\":", repeat, ",\"band\":", stress_band, ",\"min_mb_per_s\":", min_mb_per_s, ",\"results\":[");
+	for (std::size_t i{}; i < std::size(benchmark::stress_kinds); ++i) {
+		auto const& kind = benchmark::stress_kinds[i];
+		auto const quarter = kind.make(size / 4);
+		auto const full = kind.make(size);
+		auto const check = [&](char const* lexer, auto& lex, bool last) {
+			auto q = benchmark::measure(kind.name, lexer, quarter, repeat, lex);
+			auto f = benchmark::measure(kind.name, lexer, full, repeat, lex);
+			bool pass = f.mb_per_second() >= q.mb_per_second() * stress_band && f.mb_per_second() >= min_mb_per_s;
+			passed = passed && pass;
+			println("{\"corpus\":\"", fast_io::mnp::os_c_str(kind.name), "\",\"lexer\":\"", fast_io::mnp::os_c_str(lexer),
+				"\",\"bytes\":", f.bytes, ",\"mb_per_s_quarter\":", q.mb_per_second(), ",\"mb_per_s\":", f.mb_per_second(),
+				",\"pass\":", pass ? "true" : "false", "}", last ? "" : ",");
+		};
+		check("scanner", scan, false);
+		check("tokenize_all", tokenize, i + 1 == std::size(benchmark::stress_kinds));
+	}
+	println("],\"pass\":", passed ? "true" : "false", "}");
+	return passed ? 0 : 1;
+}
+
+// bench [size in MiB] [repeat] [corpus...]
+// prints one JSON document with a result per corpus and lexer
+int main(int argc, char** argv)
+{
+	frontend::init_terminal_identifiers();
+	if (argc > 1 && std::string_view{ argv[1] } == "stress")
+		return run_stress(argc, argv);
+	std::size_t size = (argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16) << 20;
+	std::size_t repeat = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+	if (size == 0 || repeat == 0)
+		panic("usage: bench [size in MiB] [repeat] [corpus...]\n");
+	std::vector<benchmark::corpus_kind_t const*> kinds;
+	for (int i{ 3 }; i < argc; ++i) {
+		auto kind = benchmark::find_corpus_kind(argv[i]);
+		if (!kind) panic("unknown corpus \"", fast_io::mnp::os_c_str(argv[i]), "\"\n");
+		kinds.push_back(kind);
+	}
+	if (kinds.empty())
+		for (auto const& kind : benchmark::corpus_kinds) kinds.push_back(&kind);
+
+	std::vector<benchmark::result_t> results;
+	for (auto kind : kinds) {
+		auto source = benchmark::make_corpus(kind->mix, size, 1);
+		results.push_back(benchmark::measure(kind->name, "scanner", source, repeat, [](std::string_view source) {
+			frontend::scanner_t lex{ "bench", source };
+			std::size_t n{ 1 };
+			while (lex.next_token().tokenkind != frontend::token_e::L_EOF) ++n;
+			return n;
+		}));
+		results.push_back(benchmark::measure(kind->name, "scanner_lex_only", source, repeat, [](std::string_view source) {
+			frontend::basic_scanner_t<frontend::lex_only_policy> lex{ "bench", source };
+			std::size_t n{ 1 };
+			while (lex.next_token().tokenkind != frontend::token_e::L_EOF) ++n;
+			return n;
+		}));
+		frontend::token_buffer_t buffer;
+		results.push_back(benchmark::measure(kind->name, "tokenize_all", source, repeat, [&](std::string_view source) {
+			frontend::tokenize_all(buffer, source, "bench");
+			return buffer.size();
+		}));
+		frontend::trivia_t trivia;
+		results.push_back(benchmark::measure(kind->name, "tokenize_all_trivia", source, repeat, [&](std::string_view source) {
+			frontend::tokenize_all(buffer, source, "bench", {}, nullptr, &trivia);
+			return buffer.size();
+		}));
+	}
+	println("{\"size\":", size, ",\"repeat\":", repeat, ",\"results\":[");
+	for (std::size_t i{}; i < results.size(); ++i)
+		println(results[i].to_json(), i + 1 == results.size() ? "" : ",");
+	println("]}");
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "../utils.hpp"
+#include "../frontend/frontend.hpp"
+
+// Synthetic sources for the lexer benchmark.
+// A corpus is a random sequence of tokens drawn with the weights of a token mix, so one
+// kind of token can be made to dominate. The generator is seeded and self-contained,
+// so a corpus is the same bytes on every platform and every run.
+namespace benchmark {
+	// xorshift64*, std distributions are not the same across standard libraries
+	struct rng_t {
+		std::uint64_t state;
+		explicit rng_t(std::uint64_t seed) : state(seed * 0x9e37'79b9'7f4a'7c15 | 1) {}
+		std::uint64_t next() noexcept {
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return state * 0x2545'f491'4f6c'dd1d;
+		}
+		// in [0, n)
+		std::size_t below(std::size_t n) noexcept {
+			return static_cast<std::size_t>(next() % n);
+		}
+		// in [lo, hi]
+		std::size_t between(std::size_t lo, std::size_t hi) noexcept {
+			return lo + below(hi - lo + 1);
+		}
+	};
+
+	// relative weights of the kinds of tokens in a corpus
+	struct token_mix_t {
+		unsigned identifiers;
+		unsigned numbers;
+		unsigned comments;
+		unsigned strings;
+		unsigned operators;
+		// string lengths are drawn from [min_string, max_string]
+		std::size_t min_string;
+		std::size_t max_string;
+		// percentage of identifiers and string characters that are CJK ideographs
+		unsigned cjk_percent;
+	};
+
+	struct corpus_kind_t {
+		char const* name;
+		token_mix_t mix;
+	};
+	inline constexpr corpus_kind_t corpus_kinds[] = {
+		{ "mixed", { 40, 10, 5, 5, 40, 4, 40, 0 } },
+		{ "identifiers", { 90, 0, 0, 0, 10, 4, 40, 0 } },
+		{ "numbers", { 10, 80, 0, 0, 10, 4, 40, 0 } },
+		{ "comments", { 10, 0, 80, 0, 10, 4, 40, 0 } },
+		{ "strings", { 10, 0, 0, 80, 10, 256, 16384, 0 } },
+		{ "operators", { 5, 0, 0, 0, 95, 4, 40, 0 } },
+		{ "cjk", { 40, 10, 5, 10, 35, 4, 40, 50 } },
+	};
+	inline corpus_kind_t const* find_corpus_kind(std::string_view name) noexcept {
+		for (auto const& kind : corpus_kinds)
+			if (name == kind.name) return &kind;
+		return nullptr;
+	}
+
+	namespace details {
+		inline constexpr std::string_view identifier_head = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+		inline constexpr std::string_view identifier_tail = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+		inline constexpr std::string_view comment_words[] = { "the", "token", "is", "lexed", "when", "a", "scanner", "of", "bytes", "reads" };
+
+		// one of U+4E00..U+9FA5
+		inline void append_ideograph(std::string& out, rng_t& rng)
+		{
+			auto c = static_cast<char32_t>(0x4e00 + rng.below(0x9fa6 - 0x4e00));
+			out += static_cast<char>(0xe0 | c >> 12);
+			out += static_cast<char>(0x80 | (c >> 6 & 0x3f));
+			out += static_cast<char>(0x80 | (c & 0x3f));
+		}
+		inline void append_identifier(std::string& out, rng_t& rng, token_mix_t const& mix)
+		{
+			if (mix.cjk_percent != 0 && rng.below(100) < mix.cjk_percent) {
+				for (auto n = rng.between(1, 6); n > 0; --n)
+					append_ideograph(out, rng);
+				return;
+			}
+			// a quarter of identifiers are keywords, as in real code
+			if (rng.below(4) == 0) {
+				auto const& keyword = frontend::details::keyword_spellings[rng.below(std::size(frontend::details::keyword_spellings))];
+				out += keyword.spelling;
+				return;
+			}
+			out += identifier_head[rng.below(identifier_head.size())];
+			for (auto n = rng.between(0, 15); n > 0; --n)
+				out += identifier_tail[rng.below(identifier_tail.size())];
+		}
+		inline void append_digits(std::string& out, rng_t& rng, std::size_t n, unsigned radix)
+		{
+			constexpr std::string_view digits = "0123456789abcdef";
+			out += digits[rng.between(1, radix - 1)];
+			while (--n > 0) out += digits[rng.below(radix)];
+		}
+		inline void append_number(std::string& out, rng_t& rng)
+		{
+			switch (rng.below(6)) {
+			case 0:
+				out += "0x";
+				append_digits(out, rng, rng.between(1, 16), 16);
+				break;
+			case 1:
+				out += "0b";
+				append_digits(out, rng, rng.between(1, 32), 2);
+				break;
+			case 2:
+				append_digits(out, rng, rng.between(1, 8), 10);
+				out += '.';
+				append_digits(out, rng, rng.between(1, 8), 10);
+				if (rng.below(2)) {
+					out += 'e';
+					if (rng.below(2)) out += '-';
+					append_digits(out, rng, rng.between(1, 2), 10);
+				}
+				break;
+			case 3:
+				out += '\'';
+				out += identifier_tail[rng.below(identifier_tail.size())];
+				out += '\'';
+				break;
+			default:
+				append_digits(out, rng, rng.between(1, 10), 10);
+			}
+		}
+		inline void append_comment(std::string& out, rng_t& rng)
+		{
+			bool block = rng.below(2);
+			out += block ? "/*" : "//";
+			for (auto n = rng.between(2, 24); n > 0; --n) {
+				out += ' ';
+				out += comment_words[rng.below(std::size(comment_words))];
+				if (block && rng.below(8) == 0) out += '\n';
+			}
+			out += block ? " */" : "\n";
+		}
+		inline void append_string(std::string& out, rng_t& rng, token_mix_t const& mix)
+		{
+			auto n = rng.between(mix.min_string, mix.max_string);
+			// one in eight is a raw string
+			bool raw = rng.below(8) == 0;
+			out += raw ? "##`" : "\"";
+			for (std::size_t i{}; i < n; ++i) {
+				auto r = rng.below(64);
+				if (!raw && r == 0) {
+					out += '\\';
+					out += "nt\"\\"[rng.below(4)];
+				}
+				else if (r < 8) out += ' ';
+				else if (mix.cjk_percent != 0 && rng.below(100) < mix.cjk_percent) append_ideograph(out, rng);
+				else out += identifier_tail[rng.below(identifier_tail.size())];
+			}
+			out += raw ? "`##" : "\"";
+		}
+		inline void append_operator(std::string& out, rng_t& rng)
+		{
+			out += frontend::details::operator_spellings[rng.below(std::size(frontend::details::operator_spellings))].spelling;
+		}
+	} // namespace details
+
+	// about `size` bytes of tokens drawn from `mix`, separated by spaces and newlines.
+	// every token is complete and lexes without an error.
+	inline std::string make_corpus(token_mix_t const& mix, std::size_t size, std::uint64_t seed)
+	{
+		rng_t rng{ seed };
+		std::string out;
+		out.reserve(size + mix.max_string + 256);
+		auto const total = mix.identifiers + mix.numbers + mix.comments + mix.strings + mix.operators;
+		while (out.size() < size) {
+			auto r = rng.below(total);
+			if (r < mix.identifiers) details::append_identifier(out, rng, mix);
+			else if ((r -= mix.identifiers) < mix.numbers) details::append_number(out, rng);
+			else if ((r -= mix.numbers) < mix.comments) details::append_comment(out, rng);
+			else if ((r -= mix.comments) < mix.strings) details::append_string(out, rng, mix);
+			else details::append_operator(out, rng);
+			// a separator keeps neighbours from lexing as one token, e.g. "/" "/"
+			out += rng.below(12) == 0 ? '\n' : ' ';
+		}
+		return out;
+	}
+} // namespace benchmark
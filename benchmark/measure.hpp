@@ -0,0 +1,92 @@
+#pragma once
+#include "../utils.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCHMARK_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_HAS_RDTSC 1
+#endif
+
+// Timing of one lexing run over a corpus, best of several repeats.
+namespace benchmark {
+	// counted by the replaceable operator new of the benchmark executable
+	inline std::atomic<std::uint64_t> allocation_cnt{};
+
+	inline std::uint64_t read_cycles() noexcept {
+#ifdef BENCHMARK_HAS_RDTSC
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	struct result_t {
+		char const* corpus;
+		char const* lexer;
+		std::size_t bytes;
+		std::size_t tokens;
+		// of the fastest repeat
+		double seconds;
+		std::uint64_t cycles;
+		// per repeat, on average
+		double allocations;
+
+		double mb_per_second() const noexcept {
+			return static_cast<double>(bytes) / 1e6 / seconds;
+		}
+		double tokens_per_second() const noexcept {
+			return static_cast<double>(tokens) / seconds;
+		}
+		double cycles_per_token() const noexcept {
+			return static_cast<double>(cycles) / static_cast<double>(tokens);
+		}
+		double allocations_per_token() const noexcept {
+			return allocations / static_cast<double>(tokens);
+		}
+		// one JSON object. cycles are reference cycles of the time stamp counter,
+		// null where there is none.
+		std::string to_json() const {
+			return fast_io::concat(
+				"{\"corpus\":\"", fast_io::mnp::os_c_str(corpus),
+				"\",\"lexer\":\"", fast_io::mnp::os_c_str(lexer),
+				"\",\"bytes\":", bytes,
+				",\"tokens\":", tokens,
+				",\"seconds\":", seconds,
+				",\"mb_per_s\":", mb_per_second(),
+				",\"tokens_per_s\":", tokens_per_second(),
+#ifdef BENCHMARK_HAS_RDTSC
+				",\"cycles_per_token\":", cycles_per_token(),
+#else
+				",\"cycles_per_token\":null",
+#endif
+				",\"allocations_per_token\":", allocations_per_token(),
+				"}");
+		}
+	};
+
+	// runs `lex(source)`, which returns the number of tokens, `repeat` times
+	template <typename Lex>
+	inline result_t measure(char const* corpus, char const* lexer, std::string_view source, std::size_t repeat, Lex&& lex)
+	{
+		result_t r{ corpus, lexer, source.size(), 0, std::numeric_limits<double>::infinity(), 0, 0 };
+		std::uint64_t allocations{};
+		for (std::size_t i{}; i < repeat; ++i) {
+			auto const allocations_before = allocation_cnt.load(std::memory_order_relaxed);
+			auto const t0 = std::chrono::steady_clock::now();
+			auto const c0 = read_cycles();
+			r.tokens = lex(source);
+			auto const c1 = read_cycles();
+			auto const t1 = std::chrono::steady_clock::now();
+			allocations += allocation_cnt.load(std::memory_order_relaxed) - allocations_before;
+			double seconds = std::chrono::duration<double>(t1 - t0).count();
+			if (seconds < r.seconds) {
+				r.seconds = seconds;
+				r.cycles = c1 - c0;
+			}
+		}
+		r.allocations = static_cast<double>(allocations) / static_cast<double>(repeat);
+		return r;
+	}
+} // namespace benchmark
@@ -0,0 +1,146 @@
+#pragma once
+#include "../utils.hpp"
+#include "corpus.hpp"
+
+// Pathological sources for the lexer, each made of one construct that a careless scanner
+// handles in more than linear time or stack: blank runs, huge comments and strings, long
+// numbers, '#' runs and operators without separators. The stress run lexes each at two
+// sizes and fails if throughput drops with size or falls under a floor.
+namespace benchmark {
+	struct stress_kind_t {
+		char const* name;
+		// about `size` bytes of the construct
+		std::string(*make)(std::size_t size);
+	};
+
+	namespace details {
+		inline constexpr std::size_t stress_string_size = std::size_t{ 1 } << 20;
+
+		inline std::string make_blank_lines(std::size_t size)
+		{
+			return std::string(size, '\n');
+		}
+		inline std::string make_continuations(std::size_t size)
+		{
+			std::string out;
+			out.reserve(size + 3);
+			while (out.size() < size) out += " \\\n";
+			return out;
+		}
+		// one comment, with '*' and '/' that do not close it
+		inline std::string make_giant_comment(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out = "/*";
+			out.reserve(size + 32);
+			while (out.size() < size) {
+				out += comment_words[rng.below(std::size(comment_words))];
+				switch (rng.below(8)) {
+				case 0: out += " * "; break;
+				case 1: out += " / "; break;
+				case 2: out += '\n'; break;
+				default: out += ' ';
+				}
+			}
+			out += "*/";
+			return out;
+		}
+		// strings of a megabyte, with escapes
+		inline std::string make_giant_strings(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out;
+			out.reserve(size + stress_string_size + 8);
+			while (out.size() < size) {
+				out += '"';
+				for (std::size_t i{}; i < stress_string_size; ++i) {
+					if (rng.below(64) == 0) {
+						out += '\\';
+						out += "nt\"\\"[rng.below(4)];
+					}
+					else out += identifier_tail[rng.below(identifier_tail.size())];
+				}
+				out += "\"\n";
+			}
+			return out;
+		}
+		// raw strings of a megabyte, full of '`' and '#' runs one '#' too short to close them
+		inline std::string make_giant_raw_strings(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out;
+			out.reserve(size + stress_string_size + 16);
+			while (out.size() < size) {
+				auto const begin = out.size();
+				out += "####`";
+				while (out.size() - begin < stress_string_size) {
+					out += identifier_tail[rng.below(identifier_tail.size())];
+					if (rng.below(4) == 0) out += "`###";
+				}
+				out += "`####\n";
+			}
+			return out;
+		}
+		// decimal and float literals of a megabyte
+		inline std::string make_long_digits(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out;
+			out.reserve(size + 2 * stress_string_size + 8);
+			while (out.size() < size) {
+				append_digits(out, rng, stress_string_size, 10);
+				out += ' ';
+				append_digits(out, rng, stress_string_size / 2, 10);
+				out += '.';
+				append_digits(out, rng, stress_string_size / 2, 10);
+				out += "e-";
+				append_digits(out, rng, 16, 10);
+				out += '\n';
+			}
+			return out;
+		}
+		// operators back to back, with nothing between them that would start a comment
+		inline std::string make_operator_runs(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out;
+			out.reserve(size + 16);
+			while (out.size() < size) {
+				auto spelling = frontend::details::operator_spellings[rng.below(std::size(frontend::details::operator_spellings))].spelling;
+				if (!out.empty() && out.back() == '/' && (spelling.front() == '/' || spelling.front() == '*'))
+					out += ' ';
+				out += spelling;
+			}
+			return out;
+		}
+		inline std::string make_hash_run(std::size_t size)
+		{
+			return std::string(size, '#');
+		}
+		// lines that are errors, lexed with a diagnostics vector
+		inline std::string make_illegal_lines(std::size_t size)
+		{
+			rng_t rng{ 1 };
+			std::string out;
+			out.reserve(size + 64);
+			while (out.size() < size) {
+				out += "a = \"not terminated";
+				for (auto n = rng.between(0, 40); n > 0; --n) out += identifier_tail[rng.below(identifier_tail.size())];
+				out += '\n';
+			}
+			return out;
+		}
+	} // namespace details
+
+	inline constexpr stress_kind_t stress_kinds[] = {
+		{ "blank_lines", details::make_blank_lines },
+		{ "continuations", details::make_continuations },
+		{ "giant_comment", details::make_giant_comment },
+		{ "giant_strings", details::make_giant_strings },
+		{ "giant_raw_strings", details::make_giant_raw_strings },
+		{ "long_digits", details::make_long_digits },
+		{ "operator_runs", details::make_operator_runs },
+		{ "hash_run", details::make_hash_run },
+		{ "illegal_lines", details::make_illegal_lines },
+	};
+} // namespace benchmark
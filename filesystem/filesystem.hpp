@@ -16,13 +16,24 @@ struct file_t
 	}
 };
 inline std::vector<file_t> opened_files;
+// the index of each file in opened_files by its name, so that opening many files stays linear
+inline std::unordered_map<std::string_view, std::size_t> opened_file_index;
+// guards both, files are loaded outside of it so that threads load them at the same time
+inline std::mutex opened_files_mutex;
+// may be called from many threads. the content of a file stays where it is when others are opened.
 inline std::string_view open_file(char const* filename) {
-	for (auto const& f : opened_files) {
-		if (std::strcmp(filename, f.filename) == 0)
-			return f.get_file_content();
+	{
+		std::lock_guard lock{ opened_files_mutex };
+		if (auto itr = opened_file_index.find(filename); itr != opened_file_index.end())
+			return opened_files[itr->second].get_file_content();
 	}
-	opened_files.emplace_back(filename);
-	return opened_files.back().get_file_content();
+	fast_io::native_file_loader loader(fast_io::mnp::os_c_str(filename));
+	std::lock_guard lock{ opened_files_mutex };
+	// another thread may have loaded it meanwhile
+	auto [itr, inserted] = opened_file_index.emplace(filename, opened_files.size());
+	if (inserted)
+		opened_files.emplace_back(filename, std::move(loader));
+	return opened_files[itr->second].get_file_content();
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// Bump allocation of bytes in blocks that are never moved or freed before the arena.
+	// Anything larger than a block gets a block of its own.
+	struct string_arena_t {
+		static constexpr std::size_t block_size = std::size_t{ 1 } << 16;
+
+		char* allocate(std::size_t n)
+		{
+			if (n > left) {
+				auto size = std::max(block_size, n);
+				blocks.push_back(std::make_unique<char[]>(size));
+				cur = blocks.back().get();
+				left = size;
+			}
+			auto p = cur;
+			cur += n;
+			left -= n;
+			return p;
+		}
+		std::string_view store(std::string_view s)
+		{
+			auto p = allocate(s.size());
+			std::memcpy(p, s.data(), s.size());
+			return { p, s.size() };
+		}
+		// gives back the end of the last allocation
+		void shrink_last(char* new_end) noexcept
+		{
+			assert(!blocks.empty() && blocks.back().get() <= new_end && new_end <= cur);
+			left += cur - new_end;
+			cur = new_end;
+		}
+	private:
+		std::vector<std::unique_ptr<char[]>> blocks;
+		char* cur{};
+		std::size_t left{};
+	};
+} // namespace frontend
@@ -45,42 +45,48 @@ namespace frontend {
 	// may be std::vector is better because the indexes are mainly contiguous
 	inline std::unordered_map<std::size_t, std::string> identifiers;
 	inline std::unordered_map<std::string, std::size_t> terminals;
+	inline std::once_flag terminal_identifiers_once;
+	// Fills the maps once, however often and from however many threads it is called. Lexing
+	// only reads them after, but the grammar parser adds its nonterminals, so it must not
+	// run while other threads lex.
 	inline void init_terminal_identifiers()
 	{
-		using enum token_e;
-		terminals.emplace("l_eof", static_cast<std::size_t>(L_EOF));
-		identifiers.emplace(static_cast<std::size_t>(L_EOF), "l_eof");
-		terminals.emplace("l_comment", static_cast<std::size_t>(COMMENT));
-		identifiers.emplace(static_cast<std::size_t>(COMMENT), "l_comment");
-		terminals.emplace("l_int_char", static_cast<std::size_t>(INT_CHAR));
-		identifiers.emplace(static_cast<std::size_t>(INT_CHAR), "l_int_char");
-		terminals.emplace("l_int_bin", static_cast<std::size_t>(INT_BIN));
-		identifiers.emplace(static_cast<std::size_t>(INT_BIN), "l_int_bin");
-		terminals.emplace("l_int_oct", static_cast<std::size_t>(INT_OCT));
-		identifiers.emplace(static_cast<std::size_t>(INT_OCT), "l_int_oct");
-		terminals.emplace("l_int_dec", static_cast<std::size_t>(INT_DEC));
-		identifiers.emplace(static_cast<std::size_t>(INT_DEC), "l_int_dec");
-		terminals.emplace("l_int_hex", static_cast<std::size_t>(INT_HEX));
-		identifiers.emplace(static_cast<std::size_t>(INT_HEX), "l_int_hex");
-		terminals.emplace("l_float_dec", static_cast<std::size_t>(FLOAT_DEC));
-		identifiers.emplace(static_cast<std::size_t>(FLOAT_DEC), "l_float_dec");
-		terminals.emplace("l_float_hex", static_cast<std::size_t>(FLOAT_HEX));
-		identifiers.emplace(static_cast<std::size_t>(FLOAT_HEX), "l_float_hex");
-		terminals.emplace("l_string", static_cast<std::size_t>(STRING));
-		identifiers.emplace(static_cast<std::size_t>(STRING), "l_string");
-		terminals.emplace("l_raw_string", static_cast<std::size_t>(RAW_STRING));
-		identifiers.emplace(static_cast<std::size_t>(RAW_STRING), "l_raw_string");
-		terminals.emplace("l_ident", static_cast<std::size_t>(IDENT));
-		identifiers.emplace(static_cast<std::size_t>(IDENT), "l_ident");
+		std::call_once(terminal_identifiers_once, [] {
+			using enum token_e;
+			terminals.emplace("l_eof", static_cast<std::size_t>(L_EOF));
+			identifiers.emplace(static_cast<std::size_t>(L_EOF), "l_eof");
+			terminals.emplace("l_comment", static_cast<std::size_t>(COMMENT));
+			identifiers.emplace(static_cast<std::size_t>(COMMENT), "l_comment");
+			terminals.emplace("l_int_char", static_cast<std::size_t>(INT_CHAR));
+			identifiers.emplace(static_cast<std::size_t>(INT_CHAR), "l_int_char");
+			terminals.emplace("l_int_bin", static_cast<std::size_t>(INT_BIN));
+			identifiers.emplace(static_cast<std::size_t>(INT_BIN), "l_int_bin");
+			terminals.emplace("l_int_oct", static_cast<std::size_t>(INT_OCT));
+			identifiers.emplace(static_cast<std::size_t>(INT_OCT), "l_int_oct");
+			terminals.emplace("l_int_dec", static_cast<std::size_t>(INT_DEC));
+			identifiers.emplace(static_cast<std::size_t>(INT_DEC), "l_int_dec");
+			terminals.emplace("l_int_hex", static_cast<std::size_t>(INT_HEX));
+			identifiers.emplace(static_cast<std::size_t>(INT_HEX), "l_int_hex");
+			terminals.emplace("l_float_dec", static_cast<std::size_t>(FLOAT_DEC));
+			identifiers.emplace(static_cast<std::size_t>(FLOAT_DEC), "l_float_dec");
+			terminals.emplace("l_float_hex", static_cast<std::size_t>(FLOAT_HEX));
+			identifiers.emplace(static_cast<std::size_t>(FLOAT_HEX), "l_float_hex");
+			terminals.emplace("l_string", static_cast<std::size_t>(STRING));
+			identifiers.emplace(static_cast<std::size_t>(STRING), "l_string");
+			terminals.emplace("l_raw_string", static_cast<std::size_t>(RAW_STRING));
+			identifiers.emplace(static_cast<std::size_t>(RAW_STRING), "l_raw_string");
+			terminals.emplace("l_ident", static_cast<std::size_t>(IDENT));
+			identifiers.emplace(static_cast<std::size_t>(IDENT), "l_ident");
 #define KEYWORD(x, y)									\
-	terminals.emplace(y, static_cast<std::size_t>(x));	\
-	identifiers.emplace(static_cast<std::size_t>(x), y);
+		terminals.emplace(y, static_cast<std::size_t>(x));	\
+		identifiers.emplace(static_cast<std::size_t>(x), y);
 #define OPERATOR(x, y)									\
-	terminals.emplace(y, static_cast<std::size_t>(x));	\
-	identifiers.emplace(static_cast<std::size_t>(x), y);
+		terminals.emplace(y, static_cast<std::size_t>(x));	\
+		identifiers.emplace(static_cast<std::size_t>(x), y);
 #include TOKEN_GRAMMAR_FILE
 #undef OPERATOR
 #undef KEYWORD
+		});
 	}
 
 	inline constexpr bool is_literal(token_e t) noexcept {
@@ -109,8 +115,84 @@ namespace frontend {
 		return t == token_e::STRING ||
 			t == token_e::RAW_STRING;
 	}
+
+	// Keywords are recognized by a perfect hash over the length and the first, second
+	// and last characters, generated at compile time from the KEYWORD entries of the
+	// token grammar file. A hit is confirmed by a single memcmp, so identifiers are
+	// classified without building a std::string or touching `terminals`.
+	namespace details {
+		struct keyword_spelling_t {
+			std::string_view spelling;
+			token_e kind;
+		};
+		inline constexpr keyword_spelling_t keyword_spellings[] = {
+#define KEYWORD(x, y) { y, token_e::x },
+#define OPERATOR(x, y)
+#include TOKEN_GRAMMAR_FILE
+#undef OPERATOR
+#undef KEYWORD
+		};
+		inline constexpr std::size_t keyword_min_length = std::ranges::min(keyword_spellings, {}, [](auto const& k) { return k.spelling.size(); }).spelling.size();
+		inline constexpr std::size_t keyword_max_length = std::ranges::max(keyword_spellings, {}, [](auto const& k) { return k.spelling.size(); }).spelling.size();
+		static_assert(keyword_min_length >= 2, "the keyword hash reads the second character");
+
+		inline constexpr std::size_t keyword_hash_bits = 8;
+		inline constexpr std::uint32_t keyword_hash(char const* s, std::size_t n, std::uint32_t seed) noexcept {
+			std::uint32_t key = static_cast<unsigned char>(s[0])
+				| static_cast<std::uint32_t>(static_cast<unsigned char>(s[1])) << 8
+				| static_cast<std::uint32_t>(static_cast<unsigned char>(s[n - 1])) << 16
+				| static_cast<std::uint32_t>(n) << 24;
+			key *= seed;
+			key ^= key >> 16;
+			key *= 0x045d'9f3b;
+			return key >> (32 - keyword_hash_bits);
+		}
+		// the first odd multiplier that maps every keyword to its own slot
+		inline constexpr std::uint32_t keyword_hash_seed = [] {
+			for (std::uint32_t seed{ 1 }; seed < 0x10'0000; seed += 2) {
+				bool used[1u << keyword_hash_bits]{};
+				bool collided{};
+				for (auto const& k : keyword_spellings) {
+					auto h = keyword_hash(k.spelling.data(), k.spelling.size(), seed);
+					collided = collided || used[h];
+					used[h] = true;
+				}
+				if (!collided)
+					return seed;
+			}
+			return std::uint32_t{};
+		}();
+		static_assert(keyword_hash_seed != 0, "no perfect hash found for the keywords, enlarge keyword_hash_bits");
+
+		struct keyword_slot_t {
+			char spelling[keyword_max_length];
+			std::uint8_t length;
+			token_e kind;
+		};
+		inline constexpr auto keyword_slots = [] {
+			std::array<keyword_slot_t, 1u << keyword_hash_bits> slots{};
+			for (auto const& k : keyword_spellings) {
+				auto& slot = slots[keyword_hash(k.spelling.data(), k.spelling.size(), keyword_hash_seed)];
+				std::ranges::copy(k.spelling, slot.spelling);
+				slot.length = static_cast<std::uint8_t>(k.spelling.size());
+				slot.kind = k.kind;
+			}
+			return slots;
+		}();
+	} // namespace details
+
+	// returns the keyword kind of [s, s + n), or token_e::IDENT if it is not a keyword
+	inline token_e lookup_keyword(char const* s, std::size_t n) noexcept {
+		using namespace details;
+		if (n < keyword_min_length || n > keyword_max_length)
+			return token_e::IDENT;
+		auto const& slot = keyword_slots[keyword_hash(s, n, keyword_hash_seed)];
+		if (slot.length == n && std::memcmp(slot.spelling, s, n) == 0)
+			return slot.kind;
+		return token_e::IDENT;
+	}
 	inline bool is_keyword(std::string_view str) noexcept {
-		return terminals.contains(std::string{ str });
+		return lookup_keyword(str.data(), str.size()) != token_e::IDENT;
 	}
 	inline bool is_identifier(char* begin, std::size_t n) noexcept
 	{
@@ -150,5 +232,21 @@ namespace std {
 	};
 } // namespace std
 
+#include "unicode.hpp"
+#include "simd.hpp"
+#include "scanner_stats.hpp"
+#include "operator_dfa.hpp"
+#include "arena.hpp"
+#include "symbol_table.hpp"
 #include "lexer.hpp"
+#include "number.hpp"
+#include "string_literal.hpp"
+#include "trivia.hpp"
+#include "token_buffer.hpp"
+#include "token_stream.hpp"
+#include "stream_scanner.hpp"
+#include "source.hpp"
+#include "parallel_lexer.hpp"
+#include "multi_file_lexer.hpp"
+#include "incremental.hpp"
 #include "parser.hpp"
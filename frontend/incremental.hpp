@@ -0,0 +1,182 @@
+#pragma once
+#include "../utils.hpp"
+
+// Re-lexing a token buffer after an edit of its source.
+//
+// Lexing restarts at the start of the last token before the edit that did not look into
+// the edit to decide where it ends, and stops at the first new token past the edit that
+// equals an old token moved by the edit's size change. Since the scanner carries no state
+// between tokens but its position, everything from that token on is the old stream, shifted.
+// The only tokens whose start cannot be told from the buffer are raw strings, whose
+// opening '#' run is not stored, so lexing neither restarts nor stops at one.
+namespace frontend {
+	struct edit_t {
+		std::uint32_t offset;
+		// bytes of the old source removed at offset
+		std::uint32_t removed;
+		std::string_view inserted;
+	};
+	struct relex_result_t {
+		// tokens [first, first + inserted) are new, they replaced `removed` old tokens
+		std::size_t first;
+		std::size_t removed;
+		std::size_t inserted;
+	};
+
+	namespace details {
+		// where the i-th token starts, its quotes included. not for raw strings.
+		inline std::uint32_t lexeme_begin(token_e kind, std::uint32_t offset) noexcept {
+			assert(kind != token_e::RAW_STRING);
+			return kind == token_e::STRING || kind == token_e::INT_CHAR ? offset - 1 : offset;
+		}
+		// where the i-th token ends, its closing quote included. at least that for raw strings.
+		inline std::uint32_t lexeme_end(token_e kind, std::uint32_t offset, std::uint32_t length) noexcept {
+			return kind == token_e::STRING || kind == token_e::INT_CHAR || kind == token_e::RAW_STRING ? offset + length + 1 : offset + length;
+		}
+		// replaces v[first, last) with `with`
+		template <typename T>
+		inline void splice(std::vector<T>& v, std::size_t first, std::size_t last, std::vector<T> const& with)
+		{
+			auto const old_cnt = last - first;
+			if (with.size() > old_cnt) v.insert(v.begin() + last, with.size() - old_cnt, T{});
+			else v.erase(v.begin() + first + with.size(), v.begin() + last);
+			std::ranges::copy(with, v.begin() + first);
+		}
+		inline void apply_edit(line_index_t& lines, edit_t const& edit)
+		{
+			auto& starts = lines.line_starts;
+			auto const delta = static_cast<std::uint32_t>(edit.inserted.size() - edit.removed);
+			// line starts in (offset, offset + removed] followed a removed '\n'
+			auto first = std::ranges::upper_bound(starts, edit.offset) - starts.begin();
+			auto last = std::ranges::upper_bound(starts, edit.offset + edit.removed) - starts.begin();
+			std::vector<std::uint32_t> inserted;
+			simd::collect_line_starts(edit.inserted.data(), edit.inserted.data() + edit.inserted.size(), edit.offset, inserted);
+			splice(starts, first, last, inserted);
+			for (auto i = first + std::ssize(inserted); i < std::ssize(starts); ++i)
+				starts[i] += delta;
+		}
+	} // namespace details
+
+	// `buffer` and `lines` are of the source before `edit`, `source` is the source after it.
+	// Both are updated in place. A buffer lexed with a symbol table needs one here too.
+	// Diagnostics are only reported for the re-lexed tokens, and UTF-8 is only checked on the
+	// lines the inserted text is on. A buffer lexed with trivia needs them here too.
+	inline relex_result_t relex(token_buffer_t& buffer, line_index_t& lines, std::string_view source, edit_t const& edit,
+		char const* filename = "", symbol_sink_t symbols = {}, std::vector<diagnostic_t>* diagnostics = nullptr,
+		trivia_t* trivia = nullptr)
+	{
+		assert(buffer.size() != 0 && buffer.kind(buffer.size() - 1) == token_e::L_EOF);
+		if (source.size() > std::numeric_limits<std::uint32_t>::max())
+			panic("file \"", fast_io::mnp::os_c_str(filename), "\" is too large to be tokenized into 32-bit offsets\n");
+		if (!buffer.symbols.empty() && !symbols)
+			panic("a token buffer with symbols needs a symbol table to be re-lexed\n");
+		auto const delta = static_cast<std::uint32_t>(edit.inserted.size() - edit.removed);
+		auto const old_edit_end = edit.offset + edit.removed;
+		auto const new_edit_end = static_cast<std::uint32_t>(edit.offset + edit.inserted.size());
+		details::apply_edit(lines, edit);
+		{
+			auto const first_line = lines.line_starts[lines.locate(edit.offset).line];
+			auto const line_end = static_cast<char const*>(std::memchr(source.data() + new_edit_end, '\n', source.size() - new_edit_end));
+			check_utf8(source.data(), source.data() + first_line, line_end ? line_end : source.data() + source.size(), filename, diagnostics);
+		}
+
+		// the last token starting before the edit may grow into it, and the ones before it
+		// may have ended where they did because of what they saw in it
+		auto const reads_into_edit = [&](std::size_t i) {
+			auto end = details::lexeme_end(buffer.kind(i), buffer.offsets[i], buffer.lengths[i]);
+			if (end + scanner_t::lookahead > edit.offset) return true;
+			return buffer.kind(i) == token_e::HASHTAG && std::all_of(source.data() + end, source.data() + edit.offset, [](char c) { return c == '#'; });
+		};
+		std::size_t first = std::ranges::lower_bound(buffer.offsets, edit.offset) - buffer.offsets.begin();
+		if (first != 0) --first;
+		while (first != 0 && (buffer.kind(first) == token_e::RAW_STRING || reads_into_edit(first - 1))) --first;
+		std::uint32_t restart = first == 0 && (buffer.offsets.front() >= edit.offset || buffer.kind(0) == token_e::RAW_STRING)
+			? 0 : details::lexeme_begin(buffer.kind(first), buffer.offsets[first]);
+		// the trivia of the first token are lexed again with it
+		if (trivia && trivia->first[first] != trivia->first[first + 1])
+			restart = std::min(restart, trivia->offsets[trivia->first[first]]);
+
+		auto const base = source.data();
+		scanner_t lex{ filename, source };
+		lex.symbols = symbols;
+		lex.diagnostics = diagnostics;
+		auto [line, column] = lines.locate(restart);
+		lex.ptr = base + restart;
+		lex.line_count = line;
+		lex.line_begin = lex.ptr - column;
+
+		token_buffer_t fresh;
+		trivia_t fresh_trivia;
+		auto last = first;
+		for (;;) {
+			auto const gap = static_cast<std::uint32_t>(lex.ptr - base);
+			auto const pieces = fresh_trivia.size();
+			auto token = trivia ? next_significant_token(lex, fresh_trivia, base) : lex.next_token();
+			auto const offset = static_cast<std::uint32_t>(token.begin - base);
+			auto const length = static_cast<std::uint32_t>(token.end - token.begin);
+			// with trivia, what is between the token and the one before has to be past the edit too
+			if (token.tokenkind != token_e::RAW_STRING && details::lexeme_begin(token.tokenkind, offset) >= new_edit_end
+				&& (!trivia || gap >= new_edit_end)) {
+				auto const old_offset = offset - delta;
+				while (last != buffer.size() && buffer.offsets[last] < old_offset) ++last;
+				// and start where the old trivia of the token did, so that they are the same
+				auto const same_trivia = [&] {
+					auto const old_gap = trivia->first[last] != trivia->first[last + 1]
+						? trivia->offsets[trivia->first[last]] : details::lexeme_begin(token.tokenkind, old_offset);
+					return gap - delta == old_gap;
+				};
+				if (last != buffer.size() && buffer.offsets[last] == old_offset && buffer.kind(last) == token.tokenkind && buffer.lengths[last] == length
+					&& details::lexeme_begin(token.tokenkind, old_offset) >= old_edit_end && (!trivia || same_trivia())) {
+					if (trivia) {
+						fresh_trivia.first.pop_back();
+						fresh_trivia.resize(pieces);
+					}
+					break;
+				}
+			}
+			fresh.push_back(token, base);
+			if (symbols) fresh.symbols.push_back(token.symbol);
+			if (token.tokenkind == token_e::L_EOF) {
+				last = buffer.size();
+				break;
+			}
+		}
+
+		// splice the new tokens in and move the old ones after them
+		details::splice(buffer.kinds, first, last, fresh.kinds);
+		details::splice(buffer.offsets, first, last, fresh.offsets);
+		details::splice(buffer.lengths, first, last, fresh.lengths);
+		if (symbols) details::splice(buffer.symbols, first, last, fresh.symbols);
+		auto const moved = first + fresh.size();
+		for (auto i = moved; i < buffer.size(); ++i)
+			buffer.offsets[i] += delta;
+
+		auto& numbers = buffer.numbers;
+		auto const numbers_first = std::ranges::lower_bound(numbers.tokens, first) - numbers.tokens.begin();
+		auto const numbers_last = std::ranges::lower_bound(numbers.tokens, last) - numbers.tokens.begin();
+		auto fresh_tokens = std::move(fresh.numbers.tokens);
+		for (auto& t : fresh_tokens) t += static_cast<std::uint32_t>(first);
+		details::splice(numbers.tokens, numbers_first, numbers_last, fresh_tokens);
+		details::splice(numbers.values, numbers_first, numbers_last, fresh.numbers.values);
+		auto const index_delta = static_cast<std::uint32_t>(moved - last);
+		for (auto i = numbers_first + std::ssize(fresh_tokens); i < std::ssize(numbers.tokens); ++i)
+			numbers.tokens[i] += index_delta;
+
+		if (trivia) {
+			// the pieces of tokens [first, last) are replaced, the later ones move
+			auto const pieces_first = trivia->first[first];
+			auto const pieces_last = trivia->first[last];
+			details::splice(trivia->kinds, pieces_first, pieces_last, fresh_trivia.kinds);
+			details::splice(trivia->offsets, pieces_first, pieces_last, fresh_trivia.offsets);
+			details::splice(trivia->lengths, pieces_first, pieces_last, fresh_trivia.lengths);
+			for (auto i = pieces_first + fresh_trivia.size(); i < trivia->size(); ++i)
+				trivia->offsets[i] += delta;
+			for (auto& f : fresh_trivia.first) f += pieces_first;
+			details::splice(trivia->first, first, last, fresh_trivia.first);
+			auto const piece_delta = static_cast<std::uint32_t>(fresh_trivia.size() - (pieces_last - pieces_first));
+			for (auto i = moved; i < trivia->first.size(); ++i)
+				trivia->first[i] += piece_delta;
+		}
+		return { first, last - first, fresh.size() };
+	}
+} // namespace frontend
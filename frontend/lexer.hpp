@@ -6,6 +6,8 @@ namespace frontend {
 		char const* end;
 		std::size_t line;
 		std::size_t column;
+		// for IDENT tokens lexed with a symbol table
+		std::uint32_t symbol{ no_symbol };
 		std::string to_string() {
 			return fast_io::concat(
 				"Kind:", identifiers.at(std::to_underlying(tokenkind)),
@@ -16,6 +18,23 @@ namespace frontend {
 		}
 	};
 
+	struct location_t {
+		std::size_t line;
+		std::size_t column;
+	};
+
+	// a lexing error, recorded instead of thrown when the scanner has a diagnostics vector
+	struct diagnostic_t {
+		char const* filename;
+		// a string literal
+		char const* message;
+		std::size_t line;
+		std::size_t column;
+		std::string to_string() const {
+			return fast_io::concat(message, " In Line:", line, ", Column:", column, " in file ", fast_io::mnp::os_c_str(filename));
+		}
+	};
+
 	inline constexpr bool isspace(char c) noexcept
 	{
 		return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v';
@@ -54,135 +73,287 @@ namespace frontend {
 		}
 	}
 
-	struct scanner_t
+	// what a token starting with a given byte can be
+	enum class lead_e : std::uint8_t {
+		INVALID = 0,
+		OPERATOR,
+		IDENT,
+		DIGIT,
+		DOT,
+		SLASH,
+		QUOTE,
+		APOSTROPHE,
+		BACKQUOTE,
+		// '#' or the start of a ###`raw string`###
+		HASH,
+		BACKSLASH,
+		// a byte >= 0x80, which may start a non-ASCII identifier
+		UTF8,
+	};
+	inline constexpr auto lead_class = [] {
+		std::array<lead_e, 256> cls{};
+		for (std::size_t c{}; c < 256; ++c) {
+			if (details::operator_char_class[c] != 0 &&
+				details::operator_dfa.next[details::operator_start_state][details::operator_char_class[c]] != details::operator_dead_state)
+				cls[c] = lead_e::OPERATOR;
+		}
+		for (char c{ 'a' }; c <= 'z'; ++c) cls[static_cast<unsigned char>(c)] = lead_e::IDENT;
+		for (char c{ 'A' }; c <= 'Z'; ++c) cls[static_cast<unsigned char>(c)] = lead_e::IDENT;
+		cls['_'] = lead_e::IDENT;
+		for (char c{ '0' }; c <= '9'; ++c) cls[static_cast<unsigned char>(c)] = lead_e::DIGIT;
+		cls['.'] = lead_e::DOT;
+		cls['/'] = lead_e::SLASH;
+		cls['"'] = lead_e::QUOTE;
+		cls['\''] = lead_e::APOSTROPHE;
+		cls['`'] = lead_e::BACKQUOTE;
+		cls['#'] = lead_e::HASH;
+		cls['\\'] = lead_e::BACKSLASH;
+		for (std::size_t c{ 0x80 }; c < 256; ++c) cls[c] = lead_e::UTF8;
+		return cls;
+	}();
+	// every single-byte operator accepts, so the DFA never has to back off to nothing
+	static_assert([] {
+		for (std::size_t c{}; c < 256; ++c) {
+			if (lead_class[c] != lead_e::OPERATOR && lead_class[c] != lead_e::DOT && lead_class[c] != lead_e::SLASH && lead_class[c] != lead_e::HASH) continue;
+			auto s = details::operator_dfa.next[details::operator_start_state][details::operator_char_class[c]];
+			if (details::operator_dfa.accept[s] == token_e::ILLEGAL) return false;
+		}
+		return true;
+	}());
+
+	// how a scanner reports a lexing error
+	enum class error_mode_e : std::uint8_t {
+		// RECORD when the scanner has a diagnostics vector, else THROW
+		DYNAMIC,
+		// print it and throw
+		THROW,
+		// append it to the diagnostics vector, which has to be set, and lex it as an ILLEGAL token
+		RECORD,
+		// only lex it as an ILLEGAL token
+		IGNORE,
+	};
+
+	// a token without its file and position
+	struct lexeme_t {
+		token_e tokenkind;
+		char const* begin;
+		char const* end;
+		std::uint32_t symbol{ no_symbol };
+	};
+
+	// What a scanner does besides finding tokens. Every policy is compiled into a scanner
+	// of its own, which leaves out the bookkeeping the policy does not ask for.
+	struct default_policy {
+		// count lines as they are passed, so that tokens have a line and a column. without it,
+		// the position of an error is found when it is reported by counting the lines before it.
+		static constexpr bool track_positions = true;
+		// return comments as COMMENT tokens, else skip them like whitespace
+		static constexpr bool emit_comments = true;
+		static constexpr error_mode_e error_mode = error_mode_e::DYNAMIC;
+		// token_t, or lexeme_t to leave the file and position out
+		using token_type = token_t;
+		// what the scanner counts into its `stats`
+		static constexpr stats_e stats = stats_e::NONE;
+	};
+	// a pass that only looks at the tokens, e.g. to count them
+	struct lex_only_policy {
+		static constexpr bool track_positions = false;
+		static constexpr bool emit_comments = false;
+		static constexpr error_mode_e error_mode = error_mode_e::IGNORE;
+		using token_type = lexeme_t;
+		static constexpr stats_e stats = stats_e::NONE;
+	};
+	// a pass that reports every error with its position and goes on
+	struct diagnostic_policy : default_policy {
+		static constexpr error_mode_e error_mode = error_mode_e::RECORD;
+	};
+	// lexing into a token buffer, which keeps neither positions nor files
+	struct buffer_policy {
+		static constexpr bool track_positions = false;
+		static constexpr bool emit_comments = true;
+		static constexpr error_mode_e error_mode = error_mode_e::DYNAMIC;
+		using token_type = lexeme_t;
+		static constexpr stats_e stats = stats_e::NONE;
+	};
+	// any policy, counting what its scanner does
+	template <typename Base, stats_e Stats = stats_e::COUNT>
+	struct instrumented_policy : Base {
+		static constexpr stats_e stats = Stats;
+	};
+
+	template <typename Policy>
+	struct basic_scanner_t
 	{
+		// Strings and comments are taken as bytes, so a file has to be checked by
+		// check_utf8() once before it is lexed to be known as valid UTF-8. When errors are
+		// recorded, an invalid sequence outside of them is left to that check to report.
+
+		using policy_type = Policy;
+		using token_type = typename Policy::token_type;
+		static_assert(std::same_as<token_type, token_t> || std::same_as<token_type, lexeme_t>);
+		static_assert(Policy::track_positions || !std::same_as<token_type, token_t>, "a token_t has a position to track");
+
+		// the scanner reads at most this many bytes past the end of a token before deciding
+		// it ended, but for a run of '#', which it reads to its end to look for a raw string
+		static constexpr std::size_t lookahead = 4;
+
 		char const* filename;
 		char const* file_begin;
 		char const* file_end;
 
 		char const* ptr;
+		// without track_positions, these are only brought up to an error when it is reported
 		std::size_t line_count;
-		std::size_t column_count;
+		// the column of a token is its distance from the start of its line,
+		// so nothing has to be counted per byte
+		char const* line_begin;
+		// When set, an error is appended here and lexed as an ILLEGAL token up to the
+		// end of its line, where scanning goes on; nothing is printed or thrown. Reserve
+		// it up front so that dirty input does not allocate. When not set, errors are
+		// printed and thrown. This is for error_mode_e::DYNAMIC and RECORD.
+		std::vector<diagnostic_t>* diagnostics{};
+		// identifiers are interned here when set
+		symbol_sink_t symbols{};
+		// where the lexeme of the last token starts. unlike its begin, this includes the
+		// opening quote or '#' run, so what is between two lexemes is whitespace.
+		char const* token_start{};
+		// a run of '#' that was read to its end and does not open a raw string, see scan()
+		char const* hash_run_begin{};
+		char const* hash_run_end{};
+		// what was lexed so far, see scanner_stats_t
+		[[no_unique_address]] std::conditional_t<Policy::stats == stats_e::NONE, no_scanner_stats_t, scanner_stats_t> stats{};
 
-		scanner_t() = default;
-		scanner_t(char const* file_name, std::string_view f)
+		basic_scanner_t() = default;
+		basic_scanner_t(char const* file_name, std::string_view f)
 			: filename(file_name)
 			, file_begin(std::to_address(f.begin()))
 			, file_end(std::to_address(f.end()))
 			, ptr(std::to_address(f.begin()))
 			, line_count(0)
-			, column_count(0)
+			, line_begin(std::to_address(f.begin()))
 		{}
 		template <std::size_t N>
-		scanner_t(char const (&content)[N])
+		basic_scanner_t(char const (&content)[N])
 			: filename("")
 			, file_begin(content)
 			, file_end(content + N - 1)
 			, ptr(content)
 			, line_count(0)
-			, column_count(0)
+			, line_begin(content)
 		{}
 
-		void consume_comment(token_t& retval)
+		void consume_comment(token_type& retval)
 		{
+			// called only on "//" and "/*", other '/' tokens are operators
 			++ptr;
-			if (ptr == file_end)
-				unexpected_eof();
-			else if (*ptr == '/') {
-				while (++ptr < file_end) {
-					if (*ptr == '\n') {
-						++ptr;
-						++line_count;
-						column_count = 0;
-						retval.end = ptr;
-						retval.tokenkind = token_e::COMMENT;
-						return;
-					}
-				}
-				unexpected_eof();
-			}
-			else if (*ptr == '*') {
-				while (++ptr < file_end) {
-					++column_count;
-					if (*ptr == '*') {
-						++ptr;
-						++column_count;
-						if (ptr == file_end) {
-							consume_exceptions(retval, "Annotation is not terminated.");
-						}
-						if (*ptr == '/') {
-							++ptr;
-							++column_count;
-							retval.end = ptr;
-							retval.tokenkind = token_e::COMMENT;
-							return;
-						}
-						else if (*ptr == '*') {
-							--ptr;
-							--column_count;
-						}
-					}
-				}
-				unexpected_eof();
-			}
-			// not annotation
-			else if (*ptr == '=') {
-				++ptr;
-				++column_count;
+			if (*ptr == '/') {
+				// the newline is left to end the line, as after any other token
+				auto newline = static_cast<char const*>(std::memchr(ptr, '\n', file_end - ptr));
+				ptr = newline ? newline : file_end;
 				retval.end = ptr;
-				retval.tokenkind = token_e::MUL_ASSIGN;
+				retval.tokenkind = token_e::COMMENT;
+				count(comment_path_e::LINE);
 				return;
 			}
 			else {
+				auto comment_end = simd::find_comment_end(ptr + 1, file_end);
+				// lines are counted after an error is reported, which is where the token starts
+				if (comment_end.pos == file_end) {
+					ptr = file_end;
+					count(comment_path_e::UNTERMINATED_BLOCK);
+					unexpected_eof(retval);
+					pass_lines(comment_end.newlines, comment_end.last_newline);
+					return;
+				}
+				pass_lines(comment_end.newlines, comment_end.last_newline);
+				ptr = comment_end.pos + 2;
 				retval.end = ptr;
-				retval.tokenkind = token_e::MUL;
+				retval.tokenkind = token_e::COMMENT;
+				count(comment_path_e::BLOCK);
 				return;
 			}
 		}
-		void consume_string(token_t& retval)
+		void consume_string(token_type& retval)
 		{
-			while (++ptr < file_end) {
-				++column_count;
-				// don't consider the situation where '\n' follows '\\'
-				if (*ptr == '\\') ++ptr;
+			// a backslash before a line break continues the string on the next line, as
+			// decode_string reads it. the lines are passed once errors are reported.
+			std::size_t newlines{};
+			char const* last_newline{};
+			while ((ptr = simd::find_string_special(ptr + 1, file_end)) < file_end) {
+				if (*ptr == '\\') {
+					if (++ptr == file_end) break;
+					if (*ptr == '\r' && file_end - ptr > 1 && ptr[1] == '\n') ++ptr;
+					if (*ptr == '\n') {
+						++newlines;
+						last_newline = ptr;
+					}
+				}
 				else if (*ptr == '\n') {
 					goto STRING_NOT_TERMINATED;
 				}
-				else if (*ptr == '"') {
+				else {
+					pass_lines(newlines, last_newline);
 					++retval.begin;
 					retval.end = ptr;
 					++ptr;
-					++column_count;
 					retval.tokenkind = token_e::STRING;
 					return;
 				}
 			}
+			ptr = file_end;
 		STRING_NOT_TERMINATED:
 			consume_exceptions(retval, "String is not terminated.");
+			pass_lines(newlines, last_newline);
 		}
-		void consume_raw_string(token_t& retval)
+		void consume_raw_string(token_type& retval)
 		{
-			// TODO
+			// `...` or ###`...`###, closed by a '`' followed by as many '#' as opened.
+			// ptr is at the opening '`' and like a string the token is what is between.
+			auto const hashes = ptr - retval.begin;
+			auto const content = ptr + 1;
+			std::size_t newlines{};
+			char const* last_newline{};
+			for (auto p = content; ; p = ptr + 1) {
+				auto close = simd::find_backquote(p, file_end);
+				newlines += close.newlines;
+				if (close.last_newline)
+					last_newline = close.last_newline;
+				ptr = close.pos;
+				if (ptr == file_end) {
+					consume_exceptions(retval, "Raw string is not terminated.");
+					pass_lines(newlines, last_newline);
+					return;
+				}
+				if (file_end - (ptr + 1) >= hashes && std::all_of(ptr + 1, ptr + 1 + hashes, [](char c) { return c == '#'; }))
+					break;
+			}
+			pass_lines(newlines, last_newline);
+			retval.begin = content;
+			retval.end = ptr;
+			ptr += 1 + hashes;
+			retval.tokenkind = token_e::RAW_STRING;
 		}
-		void consume_char(token_t& retval) {
+		void consume_char(token_type& retval) {
+			// like a string, the token is what is between the quotes
 			++ptr;
-			++column_count;
-			if (*ptr == '\'')
+			if (ptr == file_end || *ptr == '\'' || *ptr == '\n')
 				goto EXCEPTION;
 			else if (*ptr == '\\') {
 				++ptr;
-				++column_count;
+				if (ptr == file_end) goto EXCEPTION;
 			}
 			++ptr;
-			++column_count;
-			if (*ptr != '\'') {
+			if (ptr == file_end || *ptr != '\'') {
 			EXCEPTION:
 				consume_exceptions(retval, "Char literal should contain one character.");
+				return;
 			}
+			++retval.begin;
 			retval.end = ptr;
+			++ptr;
 			retval.tokenkind = token_e::INT_CHAR;
 		}
-		void consume_number(token_t& retval)
+		void consume_number(token_type& retval)
 		{
 			// ERROR!
 
@@ -198,7 +369,6 @@ namespace frontend {
 			// So the FLOAT_LIT rule is now ([0-9]+\.[0-9]+|[0-9]+\.[0-9]*)([eE]-?[0-9]+)?
 			if (*ptr == '0') {
 				++ptr;
-				++column_count;
 				if (ptr == file_end)
 					goto RETURN_TOKEN_0;
 				// binary intergral
@@ -207,13 +377,13 @@ namespace frontend {
 					if (next_ptr == file_end || (*next_ptr != '0' && *next_ptr != '1'))
 						goto RETURN_TOKEN_0;
 					while (++ptr < file_end) {
-						++column_count;
 						if (*ptr != '0' && *ptr != '1') {
 							break;
 						}
 					}
 					retval.end = ptr;
 					retval.tokenkind = token_e::INT_BIN;
+					count(number_path_e::BINARY);
 					return;
 				}
 				// hex
@@ -222,66 +392,71 @@ namespace frontend {
 					if (next_ptr == file_end || !isxdigit(*next_ptr))
 						goto RETURN_TOKEN_0;
 					while (++ptr < file_end) {
-						++column_count;
 						if (!isxdigit(*ptr))
 							break;
 					}
 					retval.end = ptr;
 					retval.tokenkind = token_e::INT_HEX;
-					if (ptr == file_end) return;
+					if (ptr == file_end) {
+						count(number_path_e::HEX);
+						return;
+					}
 					// hex
 					if (*ptr == 'p' || *ptr == 'P') {
 						auto next_ptr = ptr + 1;
 						if (next_ptr == file_end || !isdigit(*next_ptr)) {
+							count(number_path_e::HEX);
 							return;
 						}
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isdigit(*ptr)) {
 								break;
 							}
 						}
 						retval.end = ptr;
 						retval.tokenkind = token_e::FLOAT_HEX;
+						count(number_path_e::HEX_EXPONENT);
 						return;
 					}
 					else if (*ptr == '.') {
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isxdigit(*ptr))
 								break;
 						}
-						if (*ptr != 'p' && *ptr != 'P' && isdigit(*++ptr)) {
+						// the exponent is not optional after a fraction
+						auto next_ptr = ptr + 1;
+						if (next_ptr < file_end && *next_ptr == '-')
+							++next_ptr;
+						if (ptr == file_end || (*ptr != 'p' && *ptr != 'P') || next_ptr >= file_end || !isdigit(*next_ptr)) {
+							count(number_path_e::ERROR);
 							consume_exceptions(retval, "Invalid hex float: missing binary exponent part.");
+							return;
 						}
-						++column_count;
+						ptr = next_ptr;
 						while (++ptr < file_end) {
-							++column_count;
-							if (!isxdigit(*ptr))
+							if (!isdigit(*ptr))
 								break;
 						}
 						retval.end = ptr;
 						retval.tokenkind = token_e::FLOAT_HEX;
+						count(number_path_e::HEX_FRACTION);
 						return;
 					}
-					else
+					else {
+						count(number_path_e::HEX);
 						return;
+					}
 				}
 				// decimal start with 0.
 				else if (*ptr == '.') {
 					while (++ptr < file_end) {
-						++column_count;
 						if (!isdigit(*ptr)) {
 							break;
 						}
 					}
-					if (*ptr == 'e' || *ptr == 'E') {
-						auto next_ptr = ptr + 1;
-						if (next_ptr == file_end || !isdigit(*next_ptr)) {
-							return;
-						}
+					// an 'e' without digits is not part of the number
+					if (ptr != file_end && (*ptr == 'e' || *ptr == 'E') && ptr + 1 != file_end && isdigit(ptr[1])) {
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isdigit(*ptr)) {
 								break;
 							}
@@ -289,12 +464,12 @@ namespace frontend {
 					}
 					retval.end = ptr;
 					retval.tokenkind = token_e::FLOAT_DEC;
+					count(number_path_e::ZERO_FRACTION);
 					return;
 				}
 				// oct integral or decimal float
 				else if (isdigit(*ptr)) {
 					while (++ptr < file_end) {
-						++column_count;
 						if (!('0' <= *ptr && *ptr <= '7')) {
 							break;
 						}
@@ -302,22 +477,18 @@ namespace frontend {
 					retval.end = ptr;
 					retval.tokenkind = token_e::INT_OCT;
 					// if there is digit, then may be decimal float
-					if (ptr == file_end)
+					if (ptr == file_end) {
+						count(number_path_e::OCTAL);
 						return;
+					}
 					if (*ptr == '.') {
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isdigit(*ptr)) {
 								break;
 							}
 						}
-						if (*ptr == 'e' || *ptr == 'E') {
-							auto next_ptr = ptr + 1;
-							if (next_ptr == file_end || !isdigit(*next_ptr)) {
-								return;
-							}
+						if (ptr != file_end && (*ptr == 'e' || *ptr == 'E') && ptr + 1 != file_end && isdigit(ptr[1])) {
 							while (++ptr < file_end) {
-								++column_count;
 								if (!isdigit(*ptr)) {
 									break;
 								}
@@ -325,83 +496,98 @@ namespace frontend {
 						}
 						retval.end = ptr;
 						retval.tokenkind = token_e::FLOAT_DEC;
+						count(number_path_e::OCTAL_FRACTION);
 						return;
 					}
 					else if (*ptr == 'e' || *ptr == 'E') {
 						auto next_ptr = ptr + 1;
 						// is still oct, but followed by a 'e'
 						if (next_ptr == file_end || !isdigit(*next_ptr)) {
+							count(number_path_e::OCTAL);
 							return;
 						}
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isdigit(*ptr)) {
 								break;
 							}
 						}
 						retval.end = ptr;
 						retval.tokenkind = token_e::FLOAT_DEC;
+						count(number_path_e::OCTAL_EXPONENT);
 						return;
 					}
 					else if (isdigit(*ptr)) {
 						while (++ptr < file_end) {
-							++column_count;
 							if (!isdigit(*ptr))
 								break;
 						}
+						if (ptr == file_end) {
+							count(number_path_e::ERROR);
+							consume_exceptions(retval, "Octave number should only contains 0-7.");
+							return;
+						}
 						if (*ptr == '.') {
 							while (++ptr < file_end) {
-								++column_count;
 								if (!isdigit(*ptr))
 									break;
 							}
 							retval.end = ptr;
 							retval.tokenkind = token_e::FLOAT_DEC;
+							count(number_path_e::LEADING_ZERO);
 							return;
 						}
 						else if (*ptr == 'e' || *ptr == 'E') {
 							auto next_ptr = ptr + 1;
 							if (next_ptr == file_end || !isdigit(*next_ptr)) {
+								count(number_path_e::ERROR);
 								consume_exceptions(retval, "Missing exponent part.");
+								return;
 							}
 							while (++ptr < file_end) {
-								++column_count;
 								if (!isdigit(*ptr)) {
 									break;
 								}
 							}
 							retval.end = ptr;
 							retval.tokenkind = token_e::FLOAT_DEC;
+							count(number_path_e::LEADING_ZERO);
 							return;
 						}
-						else
+						else {
+							count(number_path_e::ERROR);
 							consume_exceptions(retval, "Octave number should only contains 0-7.");
+							return;
+						}
 					}
-					else
+					else {
+						count(number_path_e::OCTAL);
 						return;
+					}
 				}
 				// 0 with other token
 				else {
 				RETURN_TOKEN_0:
 					retval.end = ptr;
 					retval.tokenkind = token_e::INT_DEC;
+					count(number_path_e::ZERO);
 					return;
 				}
 			}
 			// dec
 			else {
 				while (++ptr < file_end) {
-					++column_count;
 					if (!isdigit(*ptr)) break;
 				}
+				if (ptr == file_end)
+					goto RETURN_TOKEN_INT;
 				// float
 				if (*ptr == '.') {
 					while (++ptr < file_end) {
-						++column_count;
 						if (!isdigit(*ptr)) break;
 					}
 					retval.end = ptr;
 					retval.tokenkind = token_e::FLOAT_DEC;
+					count(number_path_e::DECIMAL_FRACTION);
 					return;
 				}
 				else if (*ptr == 'e' || *ptr == 'E') {
@@ -409,449 +595,295 @@ namespace frontend {
 					if (next_ptr == file_end)
 						goto RETURN_TOKEN_INT;
 					if (*next_ptr == '-') {
+						if (next_ptr + 1 == file_end || !isdigit(next_ptr[1]))
+							goto RETURN_TOKEN_INT;
 						++ptr;
-						++column_count;
 					}
 					else if (!isdigit(*next_ptr))
 						goto RETURN_TOKEN_INT;
 					while (++ptr < file_end) {
-						++column_count;
 						if (!isdigit(*ptr)) break;
 					}
 					retval.end = ptr;
 					retval.tokenkind = token_e::FLOAT_DEC;
+					count(number_path_e::DECIMAL_EXPONENT);
 					return;
 				}
 				else {
 				RETURN_TOKEN_INT:
 					retval.end = ptr;
 					retval.tokenkind = token_e::INT_DEC;
+					count(number_path_e::DECIMAL);
 					return;
 				}
 			}
 		}
-		void consume_dot(token_t& retval) noexcept
+		void consume_dot(token_type& retval) noexcept
 		{
 			//FLOAT_LIT:
-			//	([0-9]*\.[0-9]+|[0-9]+\.[0-9]*)([eE][0-9]+)?
+			//	\.[0-9]+([eE][0-9]+)?
+			// only called when a digit follows the dot
 			++ptr;
-			++column_count;
-			if (isdigit(*ptr)) {
-				while (ptr < file_end && isdigit(*ptr)) {
+			while (ptr != file_end && isdigit(*ptr))
+				++ptr;
+			if (ptr != file_end && (*ptr == 'e' || *ptr == 'E') && ptr + 1 != file_end && isdigit(ptr[1])) {
+				++ptr;
+				while (ptr != file_end && isdigit(*ptr))
 					++ptr;
-					++column_count;
-				}
-				if (ptr != file_end && (*ptr == 'e' || *ptr == 'E')) {
-					auto next_ptr = ptr + 1;
-					if (next_ptr == file_end || !isdigit(*(next_ptr))) {
-						--ptr;
-						goto FUNC_RETURN_FLOAT;
-					}
-					while (++ptr < file_end) {
-						++column_count;
-						if (!isdigit(*ptr))
-							goto FUNC_RETURN_FLOAT;
-					}
-				}
-				else
-					goto FUNC_RETURN_FLOAT;
-			}
-			else {
-				retval.end = ptr;
-				retval.tokenkind = token_e::DOT;
-				return;
-			}
-			if (false) {
-			FUNC_RETURN_FLOAT:
-				retval.end = ptr;
-				retval.tokenkind = token_e::FLOAT_DEC;
-				return;
 			}
+			retval.end = ptr;
+			retval.tokenkind = token_e::FLOAT_DEC;
+			count(number_path_e::DOT_FRACTION);
 		}
-		void consume_identifier(token_t& retval) noexcept
+		// `lead` is the length of the first letter, 1 unless it is not ASCII
+		void consume_identifier(token_type& retval, std::size_t lead) noexcept
 		{
-			// [_a-zA-Z][_a-zA-Z0-9]*
-			++ptr;
-			++column_count;
-			while (ptr < file_end && (isalnum(*ptr) || *ptr == '_')) {
-				++ptr;
-				++column_count;
+			// (XID_Start|_)XID_Continue*, that is [_a-zA-Z][_a-zA-Z0-9]* in ASCII
+			ptr = simd::skip_identifier(ptr + lead, file_end);
+			while (ptr != file_end && static_cast<unsigned char>(*ptr) >= 0x80) {
+				auto n = unicode::identifier_continue_length(ptr, file_end);
+				if (n == 0) break;
+				ptr = simd::skip_identifier(ptr + n, file_end);
 			}
 			retval.end = ptr;
-			if (terminals.contains(std::string{ retval.begin, retval.end })) {
-				retval.tokenkind = token_e{ terminals.at(std::string{ retval.begin, retval.end }) };
-			}
-			else
-				retval.tokenkind = token_e::IDENT;
+			retval.tokenkind = lookup_keyword(retval.begin, retval.end - retval.begin);
+			if (symbols && retval.tokenkind == token_e::IDENT)
+				retval.symbol = symbols({ retval.begin, retval.end });
 		}
-		void consume_one_token_op(token_t& retval) noexcept
+		void consume_operator(token_type& retval) noexcept
 		{
-			++ptr;
-			++column_count;
+			// maximal munch over the operator DFA
+			auto state = details::operator_start_state;
+			auto kind = token_e::ILLEGAL;
+			auto accepted_end = ptr;
+			for (auto p = ptr; p != file_end; ) {
+				state = details::operator_dfa.next[state][details::operator_char_class[static_cast<unsigned char>(*p++)]];
+				if (state == details::operator_dead_state) break;
+				if (details::operator_dfa.accept[state] != token_e::ILLEGAL) {
+					kind = details::operator_dfa.accept[state];
+					accepted_end = p;
+				}
+			}
+			// the lead class guarantees the first byte is an operator on its own
+			ptr = accepted_end;
 			retval.end = ptr;
+			retval.tokenkind = kind;
 		}
-		void consume_eof(token_t& retval) noexcept
+		void consume_eof(token_type& retval) noexcept
 		{
-			retval = { filename, token_e::L_EOF, ptr, ptr, line_count, column_count };
-		}
-		template <std::size_t N>
-		[[noreturn]] void consume_exceptions(token_t& retval, char const (&error_message)[N]) {
-			while (ptr != file_end && *ptr != '\n') ++ptr;
-			perrln(error_message, " In Line:", retval.line, ", Column:", retval.column, " in file ", fast_io::mnp::os_c_str(filename));
-			throw std::exception{};
+			token_start = ptr;
+			if constexpr (std::same_as<token_type, token_t>)
+				retval = { filename, token_e::L_EOF, ptr, ptr, line_count, static_cast<std::size_t>(ptr - line_begin) };
+			else
+				retval = { token_e::L_EOF, ptr, ptr };
 		}
-		[[noreturn]] void unexpected_eof()
+		template <typename Path>
+		void count(Path path) noexcept
 		{
-			perrln("unexpected eof in file: ",
-				fast_io::mnp::os_c_str(filename));
-			throw std::exception{};
+			if constexpr (Policy::stats != stats_e::NONE)
+				stats.count(path);
 		}
-
-		token_t next_token()
+		// a line break ends at `newline`, which is at most ptr
+		void pass_line(char const* newline) noexcept
 		{
-			token_t retval;
-			// skip white space
-			while (ptr != file_end && is_inline_space(*ptr)) {
-				++ptr;
-				++column_count;
-			}
-			if (ptr == file_end) {
-				consume_eof(retval);
-				return retval;
-			}
-			else if (*ptr == '\n') {
-				++ptr;
-				++line_count;
-				column_count = 0;
-				return next_token();
-			}
-			retval.filename = filename;
-			retval.line = line_count;
-			retval.column = column_count;
-			retval.begin = ptr;
-			// annotation
-			if (*ptr == '/') {
-				consume_comment(retval);
-				return retval;
-			}
-			// string
-			else if (*ptr == '"') {
-				consume_string(retval);
-				return retval;
-			}
-			// raw string
-			else if (*ptr == '`') {
-				consume_raw_string(retval);
-				return retval;
-			}
-			// char
-			else if (*ptr == '\'') {
-				consume_char(retval);
-			}
-			// number
-			else if (isdigit(*ptr)) {
-				consume_number(retval);
-				return retval;
-			}
-			else if (*ptr == '.') {
-				consume_dot(retval);
-				return retval;
-			}
-			// identifier
-			else if (isalpha(*ptr) || *ptr == '_') {
-				consume_identifier(retval);
-				return retval;
-			}
-			// change line
-			else if (*ptr == '\\') {
-				++ptr;
-				if (*ptr == '\r')
-					++ptr;
-				if (*ptr != '\n')
-					consume_exceptions(retval, "Invalid token '\\'");
-				++ptr;
+			if constexpr (Policy::track_positions) {
 				++line_count;
-				column_count = 0;
-				return next_token();
-			}
-			// operators
-			else if (*ptr == '(') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::LPAREN;
-				return retval;
-			}
-			else if (*ptr == ')') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::RPAREN;
-				return retval;
-			}
-			else if (*ptr == '[') {
-				++ptr;
-				++column_count;
-				if (*ptr == '[') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::LDBRACKET;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::LBRACKET;
-					return retval;
-				}
+				line_begin = newline + 1;
 			}
-			else if (*ptr == ']') {
-				++ptr;
-				++column_count;
-				if (*ptr == ']') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::RDBRACKET;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::RBRACKET;
-					return retval;
-				}
-			}
-			else if (*ptr == '{') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::LBRACE;
-				return retval;
-			}
-			else if (*ptr == '}') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::RBRACE;
-				return retval;
-			}
-			else if (*ptr == ',') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::COMMA;
-				return retval;
+		}
+		void pass_lines(std::size_t newlines, char const* last_newline) noexcept
+		{
+			if constexpr (Policy::track_positions) {
+				line_count += newlines;
+				if (last_newline)
+					line_begin = last_newline + 1;
 			}
-			else if (*ptr == ':') {
-				++ptr;
-				++column_count;
-				if (*ptr == ':') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::SCOPE;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::COLON;
-					return retval;
+		}
+		// where the current token starts. Without track_positions the lines from the last
+		// position found on are counted, which is linear over the errors of a pass as they
+		// come in order.
+		location_t token_location() noexcept
+		{
+			if constexpr (!Policy::track_positions) {
+				for (auto p = line_begin; (p = static_cast<char const*>(std::memchr(p, '\n', token_start - p))); ) {
+					++line_count;
+					line_begin = ++p;
 				}
 			}
-			else if (*ptr == ';') {
-				consume_one_token_op(retval);
-				retval.tokenkind = token_e::SEMICOLON;
-				return retval;
-			}
-			else if (*ptr == '+') {
-				++ptr;
-				++column_count;
-				if (*ptr == '+') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::DADD;
-					return retval;
-				}
-				else if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::ADD_ASSIGN;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::ADD;
-					return retval;
-				}
+			return { line_count, static_cast<std::size_t>(token_start - line_begin) };
+		}
+		bool records_errors() const noexcept
+		{
+			if constexpr (Policy::error_mode == error_mode_e::DYNAMIC)
+				return diagnostics != nullptr;
+			else
+				return Policy::error_mode != error_mode_e::THROW;
+		}
+		void record_error(char const* error_message)
+		{
+			if constexpr (Policy::error_mode == error_mode_e::RECORD)
+				assert(diagnostics);
+			if constexpr (Policy::error_mode != error_mode_e::IGNORE) {
+				auto [line, column] = token_location();
+				diagnostics->push_back({ filename, error_message, line, column });
 			}
-			else if (*ptr == '-') {
-				++ptr;
-				++column_count;
-				if (*ptr == '-') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::DSUB;
-					return retval;
-				}
-				else if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::SUB_ASSIGN;
-					return retval;
-				}
-				else if (*ptr == '>') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::POINTER;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::SUB;
-					return retval;
-				}
+		}
+		// returns only when errors are recorded, and the caller has to return too
+		template <std::size_t N>
+		void consume_exceptions(token_type& retval, char const (&error_message)[N]) {
+			while (ptr != file_end && *ptr != '\n') ++ptr;
+			if (!records_errors()) {
+				auto [line, column] = token_location();
+				perrln(error_message, " In Line:", line, ", Column:", column, " in file ", fast_io::mnp::os_c_str(filename));
+				throw std::exception{};
 			}
-			else if (*ptr == '*') {
-				++ptr;
-				++column_count;
-				if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::MUL_ASSIGN;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::MUL;
-					return retval;
-				}
+			record_error(error_message);
+			retval.end = ptr;
+			retval.tokenkind = token_e::ILLEGAL;
+		}
+		// an invalid UTF-8 sequence is lexed like an error, but check_utf8() has reported the
+		// file as invalid already, so it is not recorded again
+		void consume_invalid_utf8(token_type& retval) noexcept {
+			while (ptr != file_end && *ptr != '\n') ++ptr;
+			retval.end = ptr;
+			retval.tokenkind = token_e::ILLEGAL;
+		}
+		void unexpected_eof(token_type& retval)
+		{
+			if (!records_errors()) {
+				perrln("unexpected eof in file: ",
+					fast_io::mnp::os_c_str(filename));
+				throw std::exception{};
 			}
-			else if (*ptr == '%') {
-				++ptr;
-				++column_count;
-				if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::MOD_ASSIGN;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::MOD;
-					return retval;
-				}
+			record_error("unexpected eof");
+			retval.end = ptr;
+			retval.tokenkind = token_e::ILLEGAL;
+		}
+
+		token_type next_token()
+		{
+			if constexpr (Policy::stats == stats_e::NONE)
+				return scan();
+			else {
+				std::uint64_t start{};
+				if constexpr (Policy::stats == stats_e::CYCLES)
+					start = read_cycles();
+				auto token = scan();
+				if constexpr (Policy::stats == stats_e::CYCLES)
+					stats.count_cycles(token.tokenkind, read_cycles() - start);
+				stats.count_token(token.tokenkind, static_cast<std::size_t>(ptr - token_start));
+				return token;
 			}
-			else if (*ptr == '&') {
-				++ptr;
-				++column_count;
-				if (*ptr == '&') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::LAND;
-				}
-				else if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::BAND_ASSIGN;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::BAND;
+		}
+		// Every byte is passed once, but for a '#' run, which is read again when it does not
+		// open a raw string; hash_run_end keeps that from happening for each '#' of it. What
+		// is skipped between tokens is skipped in a loop, so the stack does not grow with it.
+		token_type scan()
+		{
+			token_type retval;
+			for (;;) {
+				// skip white space
+				ptr = simd::skip_inline_space(ptr, file_end);
+				if (ptr == file_end) {
+					consume_eof(retval);
 					return retval;
 				}
-			}
-			else if (*ptr == '|') {
-				++ptr;
-				++column_count;
-				if (*ptr == '|') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::LOR;
-				}
-				else if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::BOR_ASSIGN;
+				else if (*ptr == '\n') {
+					// blank lines are passed here, not by the space kernel one at a time
+					do pass_line(ptr++);
+					while (ptr != file_end && *ptr == '\n');
+					continue;
+				}
+				if constexpr (std::same_as<token_type, token_t>) {
+					retval.filename = filename;
+					retval.line = line_count;
+					retval.column = ptr - line_begin;
+				}
+				retval.begin = ptr;
+				token_start = ptr;
+				switch (lead_class[static_cast<unsigned char>(*ptr)]) {
+				// annotation
+				case lead_e::SLASH:
+					if (ptr + 1 != file_end && (ptr[1] == '/' || ptr[1] == '*')) {
+						consume_comment(retval);
+						if constexpr (!Policy::emit_comments)
+							if (retval.tokenkind == token_e::COMMENT) continue;
+						return retval;
+					}
+					break;
+				// string
+				case lead_e::QUOTE:
+					consume_string(retval);
 					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::BOR;
+				// raw string
+				case lead_e::BACKQUOTE:
+					consume_raw_string(retval);
 					return retval;
+				case lead_e::HASH: {
+					if (hash_run_begin <= ptr && ptr < hash_run_end)
+						break;
+					auto p = ptr;
+					while (p != file_end && *p == '#') ++p;
+					if (p != file_end && *p == '`') {
+						ptr = p;
+						consume_raw_string(retval);
+						return retval;
+					}
+					hash_run_begin = ptr;
+					hash_run_end = p;
+					break;
 				}
-			}
-			else if (*ptr == '^') {
-				++ptr;
-				++column_count;
-				if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::BXOR_ASSIGN;
+				// char
+				case lead_e::APOSTROPHE:
+					consume_char(retval);
 					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::XOR;
+				// number
+				case lead_e::DIGIT:
+					consume_number(retval);
 					return retval;
-				}
-			}
-			else if (*ptr == '<') {
-				++ptr;
-				++column_count;
-				if (*ptr == '<') {
-					++ptr;
-					++column_count;
-					if (*ptr == '=') {
-						consume_one_token_op(retval);
-						retval.tokenkind = token_e::SHL_ASSIGN;
+				case lead_e::DOT:
+					if (ptr + 1 != file_end && isdigit(ptr[1])) {
+						consume_dot(retval);
 						return retval;
 					}
-					else {
-						retval.end = ptr;
-						retval.tokenkind = token_e::SHL;
+					break;
+				// identifier
+				case lead_e::IDENT:
+					consume_identifier(retval, 1);
+					return retval;
+				case lead_e::UTF8:
+					if (auto n = unicode::identifier_start_length(ptr, file_end)) {
+						consume_identifier(retval, n);
 						return retval;
 					}
-				}
-				else if (*ptr == '=') {
-					++ptr;
-					++column_count;
-					if (*ptr == '>') {
-						consume_one_token_op(retval);
-						retval.tokenkind = token_e::COMPARE;
+					if (records_errors() && unicode::decode(ptr, file_end).length == 0) {
+						consume_invalid_utf8(retval);
 						return retval;
 					}
-					else {
-						retval.end = ptr;
-						retval.tokenkind = token_e::LE;
-						return retval;
-					}
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::LT;
+					consume_exceptions(retval, "Invalid letter.");
 					return retval;
-				}
-			}
-			else if (*ptr == '>') {
-				++ptr;
-				++column_count;
-				if (*ptr == '>') {
+				// change line
+				case lead_e::BACKSLASH:
 					++ptr;
-					++column_count;
-					if (*ptr == '=') {
-						consume_one_token_op(retval);
-						retval.tokenkind = token_e::SHR_ASSIGN;
-						return retval;
-					}
-					else {
-						retval.end = ptr;
-						retval.tokenkind = token_e::SHR;
+					if (ptr != file_end && *ptr == '\r')
+						++ptr;
+					if (ptr == file_end || *ptr != '\n') {
+						consume_exceptions(retval, "Invalid token '\\'");
 						return retval;
 					}
-				}
-				else if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::GE;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::GT;
-					return retval;
-				}
-			}
-			else if (*ptr == '=') {
-				++ptr;
-				++column_count;
-				if (*ptr == '=') {
-					consume_one_token_op(retval);
-					retval.tokenkind = token_e::EQ;
-					return retval;
-				}
-				else {
-					retval.end = ptr;
-					retval.tokenkind = token_e::ASSIGN;
+					pass_line(ptr++);
+					continue;
+				case lead_e::OPERATOR:
+					break;
+				case lead_e::INVALID:
+					consume_exceptions(retval, "Invalid letter.");
 					return retval;
 				}
+				consume_operator(retval);
+				return retval;
 			}
-			else
-				consume_exceptions(retval, "Invalid letter.");
-//			__assume(0);
-		}
-		token_t peek_token() const
-		{
-			auto tmp = *this;
-			return tmp.next_token();
 		}
 	};
+
+	using scanner_t = basic_scanner_t<default_policy>;
 }
\ No newline at end of file
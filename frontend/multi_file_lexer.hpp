@@ -0,0 +1,42 @@
+#pragma once
+#include "../utils.hpp"
+#include "../parallel/thread_pool.hpp"
+
+// Lexing many files on a thread pool.
+//
+// Files are handed out to the workers one at a time, so that a few large ones do not hold
+// the rest up. A worker loads its file through fs::open_file and lexes it straight into the
+// file's own buffer, so workers share nothing but the symbol table and the list of opened
+// files, which has a lock of its own.
+namespace frontend {
+	struct lexed_file_t {
+		char const* filename;
+		std::string_view source;
+		token_buffer_t tokens;
+		// the errors of this file, when they are recorded
+		std::vector<diagnostic_t> diagnostics;
+	};
+
+	// loads and lexes every file of `paths`, and returns them in the same order. With
+	// `record_errors`, errors of a file are recorded in its diagnostics and lexed as ILLEGAL
+	// tokens; else the first error is thrown after every file is done. Interning needs a
+	// concurrent table to run in parallel, with another table the files are lexed in turn.
+	inline std::vector<lexed_file_t> tokenize_files(std::span<char const* const> paths, parallel::thread_pool_t& pool,
+		symbol_sink_t symbols = {}, bool record_errors = false)
+	{
+		init_terminal_identifiers();
+		std::vector<lexed_file_t> files(paths.size());
+		auto lex = [&](std::size_t i) {
+			auto& file = files[i];
+			file.filename = paths[i];
+			file.source = fs::open_file(paths[i]);
+			tokenize_all(file.tokens, file.source, file.filename, symbols, record_errors ? &file.diagnostics : nullptr);
+		};
+		if (symbols && !symbols.concurrent) {
+			for (std::size_t i{}; i < files.size(); ++i) lex(i);
+			return files;
+		}
+		pool.for_each_index(files.size(), lex);
+		return files;
+	}
+} // namespace frontend
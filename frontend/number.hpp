@@ -0,0 +1,459 @@
+#pragma once
+#include "../utils.hpp"
+
+// Decoding of number literals, done once when the token is lexed.
+//
+// Integers are accumulated with an overflow check in their own radix. Decimal floats
+// take Clinger's exact fast path when it applies, then the Eisel-Lemire algorithm with
+// a 128-bit table of powers of five generated at compile time, and fall back to
+// std::from_chars in the rare cases neither can decide. Hex floats are exact whenever
+// the mantissa fits in 53 bits.
+namespace frontend {
+	enum class number_status_e : std::uint8_t {
+		OK = 0,
+		// the integer does not fit in 64 bits or the float is out of range
+		OVERFLOW,
+		// the float is not 0 but too small for a subnormal, and decodes to 0
+		UNDERFLOW,
+		INVALID,
+	};
+	struct number_value_t {
+		union {
+			std::uint64_t integer;
+			double floating;
+		};
+		number_status_e status;
+	};
+
+	namespace details {
+		struct u128_t {
+			std::uint64_t high;
+			std::uint64_t low;
+		};
+		inline constexpr u128_t full_multiplication(std::uint64_t a, std::uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+			auto r = static_cast<unsigned __int128>(a) * b;
+			return { static_cast<std::uint64_t>(r >> 64), static_cast<std::uint64_t>(r) };
+#else
+			std::uint64_t a_lo = a & 0xffff'ffff, a_hi = a >> 32, b_lo = b & 0xffff'ffff, b_hi = b >> 32;
+			std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+			std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffff'ffff) + lo_hi;
+			return { (hi_lo >> 32) + (cross >> 32) + hi_hi, (cross << 32) | (lo_lo & 0xffff'ffff) };
+#endif
+		}
+
+		// just enough of a big integer to generate the power table at compile time
+		struct table_bigint_t {
+			static constexpr std::size_t limb_cnt = 56;
+			std::array<std::uint32_t, limb_cnt> limbs{};
+			constexpr std::size_t bit_length() const noexcept {
+				for (auto i = limb_cnt; i-- > 0;)
+					if (limbs[i]) return i * 32 + std::bit_width(limbs[i]);
+				return 0;
+			}
+			constexpr void mul_small(std::uint32_t m) noexcept {
+				std::uint64_t carry{};
+				for (auto& l : limbs) {
+					auto t = static_cast<std::uint64_t>(l) * m + carry;
+					l = static_cast<std::uint32_t>(t);
+					carry = t >> 32;
+				}
+			}
+			constexpr void div_small(std::uint32_t d) noexcept {
+				std::uint64_t rem{};
+				for (auto i = limb_cnt; i-- > 0;) {
+					auto t = (rem << 32) | limbs[i];
+					limbs[i] = static_cast<std::uint32_t>(t / d);
+					rem = t % d;
+				}
+			}
+			constexpr void add_one() noexcept {
+				for (auto& l : limbs)
+					if (++l != 0) break;
+			}
+			// bits [from, from + 32), bits below 0 read as zero
+			constexpr std::uint32_t bits32(std::ptrdiff_t from) const noexcept {
+				auto limb = [&](std::ptrdiff_t i) -> std::uint64_t {
+					return i < 0 || i >= static_cast<std::ptrdiff_t>(limb_cnt) ? 0 : limbs[static_cast<std::size_t>(i)];
+				};
+				// floor division, `from` may be negative
+				auto i = (from + 32 * static_cast<std::ptrdiff_t>(limb_cnt)) / 32 - static_cast<std::ptrdiff_t>(limb_cnt);
+				auto shift = from - i * 32;
+				return static_cast<std::uint32_t>((limb(i) | limb(i + 1) << 32) >> shift);
+			}
+			// bits [from, from + 128) as a 128-bit number
+			constexpr u128_t bits128(std::ptrdiff_t from) const noexcept {
+				auto word = [&](std::ptrdiff_t at) {
+					return std::uint64_t{ bits32(at) } | std::uint64_t{ bits32(at + 32) } << 32;
+				};
+				return { word(from + 64), word(from) };
+			}
+			constexpr table_bigint_t shifted_right(std::size_t n) const noexcept {
+				table_bigint_t r;
+				auto const words = n / 32, shift = n % 32;
+				for (std::size_t i{}; i + words < limb_cnt; ++i) {
+					std::uint64_t pair = limbs[i + words];
+					if (i + words + 1 < limb_cnt) pair |= std::uint64_t{ limbs[i + words + 1] } << 32;
+					r.limbs[i] = static_cast<std::uint32_t>(pair >> shift);
+				}
+				return r;
+			}
+		};
+
+		inline constexpr int smallest_power_of_five = -342;
+		inline constexpr int largest_power_of_five = 308;
+		// 5^q normalized to 128 bits: truncated for q >= 0, rounded up for q < 0
+		inline constexpr auto power_of_five_128 = [] {
+			std::array<std::uint64_t, 2 * (largest_power_of_five - smallest_power_of_five + 1)> table{};
+			auto store = [&](int q, u128_t v) {
+				table[2 * (q - smallest_power_of_five)] = v.high;
+				table[2 * (q - smallest_power_of_five) + 1] = v.low;
+			};
+			table_bigint_t p;
+			p.limbs[0] = 1;
+			for (int q{}; q <= largest_power_of_five; ++q) {
+				store(q, p.bits128(static_cast<std::ptrdiff_t>(p.bit_length()) - 128));
+				p.mul_small(5);
+			}
+			// floor(2^b / 5^k) == floor(floor(2^B / 5^k) / 2^(B - b)), so one big
+			// number divided by 5 over and over gives every negative power
+			constexpr std::size_t B = table_bigint_t::limb_cnt * 32 - 1;
+			table_bigint_t r;
+			r.limbs[B / 32] = std::uint32_t{ 1 } << (B % 32);
+			table_bigint_t five_k;
+			five_k.limbs[0] = 1;
+			for (int k{ 1 }; k <= -smallest_power_of_five; ++k) {
+				r.div_small(5);
+				five_k.mul_small(5);
+				// z is the bit length of 5^k, which is never a power of two
+				auto z = five_k.bit_length();
+				auto b = k <= 27 ? z + 127 : 2 * z + 128;
+				auto c = r.shifted_right(B - b);
+				c.add_one();
+				store(-k, c.bits128(static_cast<std::ptrdiff_t>(c.bit_length()) - 128));
+			}
+			return table;
+		}();
+
+		// decimal to binary64 for w * 10^q, w != 0 and exact. returns the bits of the double.
+		inline std::uint64_t eisel_lemire(std::int64_t q, std::uint64_t w) noexcept {
+			constexpr int mantissa_bits = 52;
+			constexpr int minimum_exponent = -1023;
+			constexpr int infinite_power = 0x7ff;
+			if (w == 0 || q < smallest_power_of_five) return 0;
+			if (q > largest_power_of_five) return std::uint64_t{ infinite_power } << mantissa_bits;
+			int lz = std::countl_zero(w);
+			w <<= lz;
+			auto index = 2 * static_cast<std::size_t>(q - smallest_power_of_five);
+			auto product = full_multiplication(w, power_of_five_128[index]);
+			constexpr std::uint64_t precision_mask = ~std::uint64_t{} >> (mantissa_bits + 3);
+			if ((product.high & precision_mask) == precision_mask) {
+				auto second = full_multiplication(w, power_of_five_128[index + 1]);
+				product.low += second.high;
+				if (second.high > product.low) ++product.high;
+			}
+			int upperbit = static_cast<int>(product.high >> 63);
+			int shift = upperbit + 64 - mantissa_bits - 3;
+			std::uint64_t mantissa = product.high >> shift;
+			// floor(log2(10^q)) + 63
+			int power2 = static_cast<int>((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz - minimum_exponent;
+			if (power2 <= 0) {
+				// subnormal
+				if (-power2 + 1 >= 64) return 0;
+				mantissa >>= -power2 + 1;
+				mantissa += mantissa & 1;
+				mantissa >>= 1;
+				// rounding may have carried into the normal range
+				power2 = mantissa < (std::uint64_t{ 1 } << mantissa_bits) ? 0 : 1;
+				return (mantissa & ~(std::uint64_t{ 1 } << mantissa_bits)) | (std::uint64_t(power2) << mantissa_bits);
+			}
+			// exactly halfway between two doubles, round to even
+			if (product.low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == product.high)
+				mantissa &= ~std::uint64_t{ 1 };
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+			if (mantissa >= (std::uint64_t{ 2 } << mantissa_bits)) {
+				mantissa = std::uint64_t{ 1 } << mantissa_bits;
+				++power2;
+			}
+			mantissa &= ~(std::uint64_t{ 1 } << mantissa_bits);
+			if (power2 >= infinite_power) return std::uint64_t{ infinite_power } << mantissa_bits;
+			return mantissa | (std::uint64_t(power2) << mantissa_bits);
+		}
+
+		inline constexpr int hex_digit_value(char c) noexcept {
+			if ('0' <= c && c <= '9') return c - '0';
+			if ('a' <= c && c <= 'f') return c - 'a' + 10;
+			if ('A' <= c && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+
+		// `nonzero` when the literal has a nonzero digit
+		inline number_status_e float_status(double v, bool nonzero = false) noexcept {
+			if (std::isinf(v)) return number_status_e::OVERFLOW;
+			if (nonzero && v == 0) return number_status_e::UNDERFLOW;
+			return number_status_e::OK;
+		}
+		// roughly the exponent of the leading nonzero digit of a float without its prefix, a
+		// power of ten for decimal floats and of two for hex ones. this is enough to tell a
+		// value that rounds to 0 from one that rounds to infinity.
+		inline std::int64_t float_magnitude(std::string_view text, std::chars_format format) noexcept {
+			bool const hex = format == std::chars_format::hex;
+			std::int64_t const digit_weight = hex ? 4 : 1;
+			std::int64_t magnitude{};
+			bool seen_nonzero{}, fraction{};
+			auto p = text.data(), end = p + text.size();
+			for (; p != end; ++p) {
+				if (*p == '.') {
+					fraction = true;
+					continue;
+				}
+				auto const d = hex ? hex_digit_value(*p) : ('0' <= *p && *p <= '9' ? *p - '0' : -1);
+				if (d < 0) break;
+				if (!seen_nonzero && d == 0) {
+					if (fraction) magnitude -= digit_weight;
+					continue;
+				}
+				seen_nonzero = true;
+				if (!fraction) magnitude += digit_weight;
+			}
+			if (p != end) {
+				// the 'e' or 'p'
+				++p;
+				bool negative{};
+				if (p != end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+				std::int64_t e{};
+				for (; p != end && '0' <= *p && *p <= '9'; ++p)
+					if (e < 100'000) e = e * 10 + (*p - '0');
+				magnitude += negative ? -e : e;
+			}
+			return magnitude;
+		}
+		inline number_status_e parse_float_fallback(std::string_view text, std::chars_format format, double& value) noexcept {
+			auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, format);
+			if (ec == std::errc::result_out_of_range) {
+				// from_chars leaves the value alone when it rounds to 0 or to infinity
+				if (float_magnitude(text, format) < 0) {
+					value = 0.0;
+					return number_status_e::UNDERFLOW;
+				}
+				value = std::numeric_limits<double>::infinity();
+				return number_status_e::OVERFLOW;
+			}
+			if (ec != std::errc{} || end != text.data() + text.size()) return number_status_e::INVALID;
+			return float_status(value);
+		}
+
+		inline number_status_e decode_decimal_float(std::string_view text, double& value) noexcept {
+			constexpr std::size_t max_digits = 19;
+			auto p = text.data(), end = p + text.size();
+			std::uint64_t w{};
+			std::size_t digits{};
+			std::int64_t exp10{};
+			bool truncated{};
+			bool seen_digit{};
+			auto take = [&](char c, bool fraction) {
+				seen_digit = true;
+				if (digits == 0 && c == '0') {
+					if (fraction) --exp10;
+					return;
+				}
+				if (digits < max_digits) {
+					w = w * 10 + static_cast<std::uint64_t>(c - '0');
+					++digits;
+					if (fraction) --exp10;
+				}
+				else {
+					truncated = truncated || c != '0';
+					if (!fraction) ++exp10;
+				}
+			};
+			for (; p != end && '0' <= *p && *p <= '9'; ++p) take(*p, false);
+			if (p != end && *p == '.')
+				for (++p; p != end && '0' <= *p && *p <= '9'; ++p) take(*p, true);
+			if (!seen_digit) return number_status_e::INVALID;
+			if (p != end && (*p == 'e' || *p == 'E')) {
+				++p;
+				bool negative{};
+				if (p != end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+				if (p == end) return number_status_e::INVALID;
+				std::int64_t e{};
+				for (; p != end && '0' <= *p && *p <= '9'; ++p)
+					if (e < 100'000) e = e * 10 + (*p - '0');
+				exp10 += negative ? -e : e;
+			}
+			if (p != end) return number_status_e::INVALID;
+
+			if (w == 0) {
+				value = 0.0;
+				return number_status_e::OK;
+			}
+			// Clinger: both operands and the result are exact doubles
+			constexpr double exact_powers_of_ten[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+			if (!truncated && w <= (std::uint64_t{ 1 } << 53) && -22 <= exp10 && exp10 <= 22) {
+				value = exp10 < 0 ? static_cast<double>(w) / exact_powers_of_ten[-exp10] : static_cast<double>(w) * exact_powers_of_ten[exp10];
+				return number_status_e::OK;
+			}
+			auto bits = eisel_lemire(exp10, w);
+			// with dropped digits the true value lies in [w, w + 1) * 10^exp10
+			if (truncated && (w == ~std::uint64_t{} || eisel_lemire(exp10, w + 1) != bits))
+				return parse_float_fallback(text, std::chars_format::general, value);
+			value = std::bit_cast<double>(bits);
+			return float_status(value, true);
+		}
+
+		inline number_status_e decode_hex_float(std::string_view text, double& value) noexcept {
+			// 0x mantissa [. fraction] [p [-] exponent]
+			if (text.size() < 3) return number_status_e::INVALID;
+			auto body = text.substr(2);
+			auto p = body.data(), end = p + body.size();
+			std::uint64_t m{};
+			std::int64_t exp2{};
+			bool exact{ true };
+			auto take = [&](int d, bool fraction) {
+				if (m >> 60) {
+					// no more room, the digit only matters for rounding
+					exact = exact && d == 0;
+					if (!fraction) exp2 += 4;
+					return;
+				}
+				m = m << 4 | static_cast<std::uint64_t>(d);
+				if (fraction) exp2 -= 4;
+			};
+			for (int d; p != end && (d = hex_digit_value(*p)) >= 0; ++p) take(d, false);
+			if (p != end && *p == '.')
+				for (int d; ++p != end && (d = hex_digit_value(*p)) >= 0;) take(d, true);
+			if (p != end && (*p == 'p' || *p == 'P')) {
+				++p;
+				bool negative{};
+				if (p != end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+				std::int64_t e{};
+				for (; p != end && '0' <= *p && *p <= '9'; ++p)
+					if (e < 100'000) e = e * 10 + (*p - '0');
+				exp2 += negative ? -e : e;
+			}
+			if (p != end) return number_status_e::INVALID;
+			if (exact && m < (std::uint64_t{ 1 } << 53)) {
+				// a single rounding, at most
+				value = std::ldexp(static_cast<double>(m), static_cast<int>(std::clamp<std::int64_t>(exp2, -4000, 4000)));
+				return float_status(value, m != 0);
+			}
+			return parse_float_fallback(body, std::chars_format::hex, value);
+		}
+
+		inline std::uint64_t decode_escape(char const*& p, char const* end) noexcept {
+			// p is after the backslash
+			char c = *p++;
+			switch (c) {
+			case 'n': return '\n';
+			case 't': return '\t';
+			case 'r': return '\r';
+			case 'v': return '\v';
+			case 'f': return '\f';
+			case 'a': return '\a';
+			case 'b': return '\b';
+			case '0': return '\0';
+			case 'x': {
+				// at most the digits of one char, the ones after it are text
+				std::uint64_t v{};
+				auto const last = p + std::min<std::ptrdiff_t>(end - p, 2);
+				for (int d; p != last && (d = hex_digit_value(*p)) >= 0; ++p)
+					v = v << 4 | static_cast<std::uint64_t>(d);
+				return v;
+			}
+			default: return static_cast<unsigned char>(c);
+			}
+		}
+	} // namespace details
+
+	// false if `kind` is no integer kind. Else `status` tells whether `text` fits in 64 bits, and
+	// `value` holds the digits read up to an overflow or an invalid digit.
+	inline bool decode_integer(token_e kind, std::string_view text, std::uint64_t& value, number_status_e& status) noexcept
+	{
+		unsigned radix;
+		std::size_t prefix{};
+		// radix of each integer kind and the length of its prefix
+		switch (kind) {
+		case token_e::INT_BIN: radix = 2; prefix = 2; break;
+		case token_e::INT_OCT: radix = 8; prefix = 1; break;
+		case token_e::INT_DEC: radix = 10; break;
+		case token_e::INT_HEX: radix = 16; prefix = 2; break;
+		default: return false;
+		}
+		if (text.size() <= prefix && kind != token_e::INT_DEC) {
+			status = number_status_e::INVALID;
+			return true;
+		}
+		std::uint64_t v{};
+		status = number_status_e::OK;
+		for (auto c : text.substr(prefix)) {
+			auto d = static_cast<unsigned>(details::hex_digit_value(c));
+			if (d >= radix) {
+				status = number_status_e::INVALID;
+				break;
+			}
+			if (v > (std::numeric_limits<std::uint64_t>::max() - d) / radix) {
+				status = number_status_e::OVERFLOW;
+				break;
+			}
+			v = v * radix + d;
+		}
+		value = v;
+		return true;
+	}
+
+	// the value of a number or char literal token, `text` as lexed
+	inline number_value_t decode_number(token_e kind, std::string_view text) noexcept
+	{
+		number_value_t r;
+		r.integer = 0;
+		r.status = number_status_e::OK;
+		switch (kind) {
+		case token_e::INT_CHAR: {
+			auto p = text.data(), end = p + text.size();
+			if (p == end) r.status = number_status_e::INVALID;
+			else if (*p == '\\' && p + 1 != end) {
+				++p;
+				r.integer = details::decode_escape(p, end);
+			}
+			else r.integer = static_cast<unsigned char>(*p);
+			break;
+		}
+		case token_e::INT_BIN: case token_e::INT_OCT: case token_e::INT_DEC: case token_e::INT_HEX:
+			decode_integer(kind, text, r.integer, r.status);
+			break;
+		case token_e::FLOAT_DEC:
+			r.status = details::decode_decimal_float(text, r.floating);
+			break;
+		case token_e::FLOAT_HEX:
+			r.status = details::decode_hex_float(text, r.floating);
+			break;
+		default:
+			r.status = number_status_e::INVALID;
+		}
+		return r;
+	}
+
+	// decoded literals of a token buffer, keyed by token index in increasing order
+	struct number_table_t {
+		std::vector<std::uint32_t> tokens;
+		std::vector<number_value_t> values;
+
+		void clear() noexcept {
+			tokens.clear();
+			values.clear();
+		}
+		void push_back(std::uint32_t token, number_value_t value) {
+			assert(tokens.empty() || tokens.back() < token);
+			tokens.push_back(token);
+			values.push_back(value);
+		}
+		number_value_t const* find(std::uint32_t token) const noexcept {
+			auto itr = std::ranges::lower_bound(tokens, token);
+			if (itr == tokens.end() || *itr != token) return nullptr;
+			return &values[itr - tokens.begin()];
+		}
+	};
+} // namespace frontend
@@ -0,0 +1,66 @@
+#pragma once
+#include "../utils.hpp"
+
+// A DFA over the OPERATOR entries of the token grammar file, built at compile time.
+// Bytes are first mapped to character classes through a 256-entry table, then the
+// scanner walks a dense [state][class] transition table doing maximal munch.
+//
+// The automaton is the trie of the operator spellings. Every trie node leads to at
+// least one accepting node, and every accepting node carries its own token kind,
+// so no two states are equivalent: the trie is already the minimal DFA.
+namespace frontend::details {
+	struct operator_spelling_t {
+		std::string_view spelling;
+		token_e kind;
+	};
+	inline constexpr operator_spelling_t operator_spellings[] = {
+#define KEYWORD(x, y)
+#define OPERATOR(x, y) { y, token_e::x },
+#include TOKEN_GRAMMAR_FILE
+#undef OPERATOR
+#undef KEYWORD
+	};
+
+	// class 0 is every byte that does not appear in an operator
+	inline constexpr auto operator_char_class = [] {
+		std::array<std::uint8_t, 256> cls{};
+		std::uint8_t next{ 1 };
+		for (auto const& op : operator_spellings) {
+			for (char c : op.spelling) {
+				auto& e = cls[static_cast<unsigned char>(c)];
+				if (e == 0) e = next++;
+			}
+		}
+		return cls;
+	}();
+	inline constexpr std::size_t operator_class_cnt = std::ranges::max(operator_char_class) + std::size_t{ 1 };
+
+	// state 0 is dead, state 1 is the start state, and every other state is a trie node
+	inline constexpr std::uint8_t operator_dead_state = 0;
+	inline constexpr std::uint8_t operator_start_state = 1;
+
+	template <std::size_t StateCnt>
+	struct operator_dfa_t {
+		std::array<std::array<std::uint8_t, operator_class_cnt>, StateCnt> next{};
+		std::array<token_e, StateCnt> accept{};
+		std::size_t state_cnt{};
+
+		constexpr operator_dfa_t() {
+			accept.fill(token_e::ILLEGAL);
+			state_cnt = 2;
+			for (auto const& op : operator_spellings) {
+				std::size_t s{ operator_start_state };
+				for (char c : op.spelling) {
+					auto& t = next[s][operator_char_class[static_cast<unsigned char>(c)]];
+					if (t == operator_dead_state)
+						t = static_cast<std::uint8_t>(state_cnt++);
+					s = t;
+				}
+				accept[s] = op.kind;
+			}
+		}
+	};
+	inline constexpr std::size_t operator_state_cnt = operator_dfa_t<std::size(operator_spellings) * 3 + 2>{}.state_cnt;
+	static_assert(operator_state_cnt <= 0x100, "operator DFA states must fit in std::uint8_t");
+	inline constexpr operator_dfa_t<operator_state_cnt> operator_dfa{};
+} // namespace frontend::details
@@ -0,0 +1,226 @@
+#pragma once
+#include "../utils.hpp"
+#include "../parallel/thread_pool.hpp"
+
+// Lexing one large source on a thread pool.
+//
+// The source is cut at newlines and every chunk is lexed speculatively, as if its first
+// byte started a token. That guess is wrong when the cut falls inside a block comment,
+// a string or after a '\' continuation, so the chunks are stitched together by a real
+// scanner that walks from the end of the previous chunk: it re-lexes one token and
+// compares it with the speculative stream. Since the scanner carries no state between
+// tokens but its position, the first token both agree on proves the rest of the chunk
+// right. A wrong guess only costs re-lexing up to that token.
+namespace frontend {
+	inline constexpr std::size_t parallel_lex_min_chunk = std::size_t{ 1 } << 20;
+
+	namespace details {
+		struct lexed_chunk_t {
+			// the speculative tokens starting in this chunk, without L_EOF
+			token_buffer_t tokens;
+			std::vector<std::uint32_t> line_starts;
+			// the offset right after the last token in `tokens`
+			std::uint32_t stop;
+			// the offset of the first invalid UTF-8 sequence in the chunk, the source size if none
+			std::uint32_t invalid_utf8;
+			// errors of the speculative tokens and the index of their ILLEGAL token.
+			// their lines count from the chunk start, they are located again when stitched.
+			std::vector<diagnostic_t> diagnostics;
+			std::vector<std::uint32_t> diagnostic_tokens;
+			// of `tokens`, when trivia are asked for
+			trivia_t trivia;
+		};
+	} // namespace details
+
+	// Same result as tokenize_all(buffer, source, filename, symbols, diagnostics, trivia). If `lines`
+	// is given, the line index of the source is built along the way.
+	// Interning needs a concurrent table to run in parallel. It may intern a few names
+	// that end up in no token, when a chunk was cut inside a comment or a string.
+	inline void tokenize_parallel(token_buffer_t& buffer, std::string_view source, parallel::thread_pool_t& pool,
+		char const* filename = "", line_index_t* lines = nullptr, symbol_sink_t symbols = {},
+		std::vector<diagnostic_t>* diagnostics = nullptr, trivia_t* trivia = nullptr)
+	{
+		std::size_t chunk_cnt = std::min(pool.size() * 4, source.size() / parallel_lex_min_chunk);
+		if (pool.size() == 1 || chunk_cnt < 2 || (symbols && !symbols.concurrent)) {
+			tokenize_all(buffer, source, filename, symbols, diagnostics, trivia);
+			if (lines) lines->build(source);
+			return;
+		}
+		if (source.size() > std::numeric_limits<std::uint32_t>::max())
+			panic("file \"", fast_io::mnp::os_c_str(filename), "\" is too large to be tokenized into 32-bit offsets\n");
+		auto const base = source.data();
+		auto const size = static_cast<std::uint32_t>(source.size());
+
+		// cut right after a newline near each i * size / chunk_cnt
+		std::vector<std::uint32_t> starts{ 0 };
+		for (std::size_t i{ 1 }; i < chunk_cnt; ++i) {
+			std::uint32_t target = std::max<std::uint32_t>(static_cast<std::uint32_t>(source.size() * i / chunk_cnt), starts.back());
+			auto newline = static_cast<char const*>(std::memchr(base + target, '\n', size - target));
+			if (!newline || newline + 1 == base + size) break;
+			starts.push_back(static_cast<std::uint32_t>(newline + 1 - base));
+		}
+		starts.push_back(size);
+
+		std::vector<details::lexed_chunk_t> chunks(starts.size() - 1);
+		pool.for_each_index(chunks.size(), [&](std::size_t i) {
+			auto& chunk = chunks[i];
+			auto const limit = base + starts[i + 1];
+			simd::collect_line_starts(base + starts[i], limit, starts[i], chunk.line_starts);
+			// chunks start at line starts, so no sequence is cut
+			auto invalid = simd::find_invalid_utf8(base + starts[i], limit);
+			chunk.invalid_utf8 = invalid == limit ? size : static_cast<std::uint32_t>(invalid - base);
+			chunk.stop = starts[i];
+			chunk.tokens.reserve(estimated_token_cnt(starts[i + 1] - starts[i]));
+			scanner_t lex{ filename, { base + starts[i], base + size } };
+			lex.symbols = symbols;
+			lex.diagnostics = &chunk.diagnostics;
+			for (;;) {
+				auto const pieces = chunk.trivia.size();
+				auto token = trivia ? next_significant_token(lex, chunk.trivia, base) : lex.next_token();
+				if (token.tokenkind == token_e::L_EOF || token.begin >= limit) {
+					// its trivia are lexed again with it
+					if (trivia) {
+						chunk.trivia.first.pop_back();
+						chunk.trivia.resize(pieces);
+					}
+					break;
+				}
+				if (token.tokenkind == token_e::ILLEGAL) {
+					// when errors are thrown, the chunk stops at it, as it may only be an
+					// artifact of the guess; else it goes on past ILLEGAL tokens
+					if (!diagnostics) break;
+					chunk.diagnostic_tokens.push_back(static_cast<std::uint32_t>(chunk.tokens.size()));
+				}
+				chunk.tokens.push_back(token, base);
+				if (symbols) chunk.tokens.symbols.push_back(token.symbol);
+				chunk.stop = static_cast<std::uint32_t>(lex.ptr - base);
+			}
+			// an error in the token past the chunk belongs to the next one
+			chunk.diagnostics.resize(chunk.diagnostic_tokens.size());
+		});
+
+		line_index_t index;
+		{
+			std::size_t line_cnt{ 1 };
+			for (auto const& chunk : chunks) line_cnt += chunk.line_starts.size();
+			index.line_starts.reserve(line_cnt);
+			index.line_starts.push_back(0);
+			for (auto const& chunk : chunks)
+				index.line_starts.insert(index.line_starts.end(), chunk.line_starts.begin(), chunk.line_starts.end());
+		}
+
+		// like tokenize_all, the first invalid UTF-8 sequence is reported before any lexing error
+		for (auto const& chunk : chunks) {
+			if (chunk.invalid_utf8 == size) continue;
+			auto [line, column] = index.locate(chunk.invalid_utf8);
+			report_invalid_utf8(filename, line, column, diagnostics);
+			break;
+		}
+
+		buffer.clear();
+		buffer.reserve(estimated_token_cnt(source.size()));
+		scanner_t lex{ filename, source };
+		lex.symbols = symbols;
+		lex.diagnostics = diagnostics;
+		if (symbols) buffer.symbols.reserve(estimated_token_cnt(source.size()));
+		if (trivia) {
+			trivia->clear();
+			trivia->first.reserve(estimated_token_cnt(source.size()) + 1);
+		}
+		auto next_token = [&] {
+			return trivia ? next_significant_token(lex, *trivia, base) : lex.next_token();
+		};
+		auto jump = [&](std::uint32_t pos) {
+			auto [line, column] = index.locate(pos);
+			lex.ptr = base + pos;
+			lex.line_count = line;
+			lex.line_begin = lex.ptr - column;
+		};
+		// appends the speculative tokens of `chunk` from `first` on. The real scanner has
+		// just lexed token `first` itself and reported its error already, if any.
+		auto append = [&](details::lexed_chunk_t const& chunk, std::size_t first) {
+			auto const& from = chunk.tokens;
+			if (diagnostics) {
+				auto k = std::ranges::upper_bound(chunk.diagnostic_tokens, first) - chunk.diagnostic_tokens.begin();
+				for (; k < std::ssize(chunk.diagnostic_tokens); ++k) {
+					auto d = chunk.diagnostics[k];
+					auto [line, column] = index.locate(from.offsets[chunk.diagnostic_tokens[k]]);
+					d.line = line;
+					d.column = column;
+					diagnostics->push_back(d);
+				}
+			}
+			// the decoded numbers move along, renumbered
+			auto const shift = static_cast<std::uint32_t>(buffer.size() - first);
+			auto const& numbers = from.numbers;
+			auto n = static_cast<std::size_t>(std::ranges::lower_bound(numbers.tokens, first) - numbers.tokens.begin());
+			for (; n < numbers.tokens.size(); ++n)
+				buffer.numbers.push_back(numbers.tokens[n] + shift, numbers.values[n]);
+			buffer.kinds.insert(buffer.kinds.end(), from.kinds.begin() + first, from.kinds.end());
+			buffer.offsets.insert(buffer.offsets.end(), from.offsets.begin() + first, from.offsets.end());
+			buffer.lengths.insert(buffer.lengths.end(), from.lengths.begin() + first, from.lengths.end());
+			if (symbols)
+				buffer.symbols.insert(buffer.symbols.end(), from.symbols.begin() + first, from.symbols.end());
+			// token `first` has the trivia the real scanner found before it, the others move along
+			if (trivia && first + 1 < from.size()) {
+				auto const& pieces = chunk.trivia;
+				auto const p = pieces.first[first + 1];
+				auto const piece_shift = static_cast<std::uint32_t>(trivia->size() - p);
+				for (auto k = first + 1; k < from.size(); ++k)
+					trivia->first.push_back(pieces.first[k] + piece_shift);
+				trivia->kinds.insert(trivia->kinds.end(), pieces.kinds.begin() + p, pieces.kinds.end());
+				trivia->offsets.insert(trivia->offsets.end(), pieces.offsets.begin() + p, pieces.offsets.end());
+				trivia->lengths.insert(trivia->lengths.end(), pieces.lengths.begin() + p, pieces.lengths.end());
+			}
+		};
+		std::uint32_t pos{};
+		for (auto const& chunk : chunks) {
+			auto const& spec = chunk.tokens;
+			for (;;) {
+				auto j = static_cast<std::size_t>(std::ranges::lower_bound(spec.offsets, pos) - spec.offsets.begin());
+				if (j == spec.size()) break;
+				jump(pos);
+				auto const pieces = trivia ? trivia->size() : 0;
+				auto token = next_token();
+				auto offset = static_cast<std::uint32_t>(token.begin - base);
+				auto length = static_cast<std::uint32_t>(token.end - token.begin);
+				if (token.tokenkind == token_e::L_EOF) {
+					// lexed again below
+					if (trivia) {
+						trivia->first.pop_back();
+						trivia->resize(pieces);
+					}
+					break;
+				}
+				if (spec.kind(j) == token.tokenkind && spec.offsets[j] == offset && spec.lengths[j] == length) {
+					// in sync, a chunk that stopped at an error ends at a real one, which
+					// the real scanner throws when it gets there
+					append(chunk, j);
+					pos = chunk.stop;
+					break;
+				}
+				buffer.push_back(token, base);
+				if (symbols) buffer.symbols.push_back(token.symbol);
+				pos = static_cast<std::uint32_t>(lex.ptr - base);
+			}
+		}
+		// whatever no chunk has covered, usually nothing but trailing whitespace
+		jump(pos);
+		for (;;) {
+			auto token = next_token();
+			buffer.push_back(token, base);
+			if (symbols) buffer.symbols.push_back(token.symbol);
+			if (token.tokenkind == token_e::L_EOF) break;
+		}
+		if (trivia) trivia->first.push_back(static_cast<std::uint32_t>(trivia->size()));
+		if (lines) *lines = std::move(index);
+	}
+	inline token_buffer_t tokenize_parallel(std::string_view source, parallel::thread_pool_t& pool = parallel::default_pool(),
+		char const* filename = "", line_index_t* lines = nullptr, symbol_sink_t symbols = {},
+		std::vector<diagnostic_t>* diagnostics = nullptr, trivia_t* trivia = nullptr)
+	{
+		token_buffer_t buffer;
+		tokenize_parallel(buffer, source, pool, filename, lines, symbols, diagnostics, trivia);
+		return buffer;
+	}
+} // namespace frontend
@@ -1,7 +1,155 @@
 namespace frontend {
-	inline std::unordered_multimap<identifier_t, std::vector<identifier_t>> productions;
-
 	inline std::size_t nt_index = (sizeof(std::size_t) == 8) ? 0x8000'0000'0000'0000 : 0x8000'0000;
+	// nonterminals are numbered from 0 in the order they are first seen
+	inline constexpr std::size_t nonterminal_ordinal(identifier_t nt) noexcept {
+		return nt.index & (static_cast<std::size_t>(-1) >> 1);
+	}
+
+	// a set of terminals, indexed by their token_e value. the last bit names no terminal,
+	// the lalr construction marks the lookaheads it propagates with it.
+	using terminal_set_t = std::bitset<std::to_underlying(token_e::operator_end) + 1>;
+	inline constexpr std::size_t propagated_lookahead = std::to_underlying(token_e::operator_end);
+	template<typename F>
+	inline void for_each_terminal(terminal_set_t const& set, F&& f) {
+		for (std::size_t i{}; i < set.size(); ++i)
+			if (set.test(i)) f(identifier_t{ i });
+	}
+
+	// items keep the dot position in the low bits and the production index in the others
+	inline constexpr std::uint32_t item_step_bits = 8;
+	inline constexpr std::uint32_t max_production_length = (1u << item_step_bits) - 1;
+	inline constexpr std::size_t max_production_cnt = std::size_t{ 1 } << (32 - item_step_bits);
+
+	// a production is [offset, offset + length) of grammar_t::symbols
+	struct production_t {
+		identifier_t lhs;
+		std::uint32_t offset;
+		std::uint32_t length;
+	};
+	// All productions of the grammar with their right-hand sides in one array. Once built,
+	// the productions of a nonterminal are next to each other, in the order of the grammar
+	// file, and so are their right-hand sides. Items refer to productions by index.
+	struct grammar_t {
+		std::vector<identifier_t> symbols;
+		std::vector<production_t> productions;
+		// the productions of the i-th nonterminal are [nonterminal_first[i], nonterminal_first[i + 1])
+		std::vector<std::uint32_t> nonterminal_first;
+		// the lhs of the first production of the grammar file
+		identifier_t start{};
+		// FIRST and whether it derives the empty string, per nonterminal ordinal
+		std::vector<terminal_set_t> first_sets;
+		std::vector<std::uint8_t> nullable;
+		// FIRST of symbols[i] up to the end of its production, and whether all of that is nullable
+		std::vector<terminal_set_t> suffix_first;
+		std::vector<std::uint8_t> suffix_nullable;
+
+		void clear() noexcept {
+			symbols.clear();
+			productions.clear();
+			nonterminal_first.clear();
+			start = {};
+			first_sets.clear();
+			nullable.clear();
+			suffix_first.clear();
+			suffix_nullable.clear();
+		}
+		void add(identifier_t lhs, std::span<identifier_t const> rhs) {
+			if (productions.empty()) start = lhs;
+			productions.push_back({ lhs, static_cast<std::uint32_t>(symbols.size()), static_cast<std::uint32_t>(rhs.size()) });
+			symbols.insert(symbols.end(), rhs.begin(), rhs.end());
+		}
+		// groups the added productions by nonterminal
+		void build() {
+			std::ranges::stable_sort(productions, {}, [](production_t const& p) { return nonterminal_ordinal(p.lhs); });
+			std::vector<identifier_t> grouped;
+			grouped.reserve(symbols.size());
+			for (auto& p : productions) {
+				auto const offset = static_cast<std::uint32_t>(grouped.size());
+				grouped.insert(grouped.end(), symbols.begin() + p.offset, symbols.begin() + p.offset + p.length);
+				p.offset = offset;
+			}
+			symbols = std::move(grouped);
+			nonterminal_first.assign(nonterminals.size() + 1, 0);
+			for (auto const& p : productions)
+				++nonterminal_first[nonterminal_ordinal(p.lhs) + 1];
+			for (std::size_t i{ 1 }; i < nonterminal_first.size(); ++i)
+				nonterminal_first[i] += nonterminal_first[i - 1];
+			compute_first_sets();
+		}
+		// iterates to a fixed point, so left recursion, direct or not, and nullable prefixes
+		// need no special care
+		void compute_first_sets() {
+			first_sets.assign(nonterminals.size(), {});
+			nullable.assign(nonterminals.size(), 0);
+			for (bool changed{ true }; changed;) {
+				changed = false;
+				for (std::uint32_t p{}; p < productions.size(); ++p) {
+					auto const lhs = nonterminal_ordinal(productions[p].lhs);
+					auto set = first_sets[lhs];
+					bool rhs_nullable{ true };
+					for (auto sym : rhs(p)) {
+						set |= first(sym);
+						if (!is_nullable(sym)) {
+							rhs_nullable = false;
+							break;
+						}
+					}
+					if (set != first_sets[lhs]) {
+						first_sets[lhs] = set;
+						changed = true;
+					}
+					if (rhs_nullable && !nullable[lhs]) {
+						nullable[lhs] = true;
+						changed = true;
+					}
+				}
+			}
+			suffix_first.assign(symbols.size(), {});
+			suffix_nullable.assign(symbols.size(), 0);
+			for (auto const& p : productions) {
+				terminal_set_t set;
+				bool is_null{ true };
+				for (auto i = p.offset + p.length; i-- > p.offset;) {
+					if (!is_nullable(symbols[i])) {
+						set.reset();
+						is_null = false;
+					}
+					set |= first(symbols[i]);
+					suffix_first[i] = set;
+					suffix_nullable[i] = is_null;
+				}
+			}
+		}
+		std::span<identifier_t const> rhs(std::uint32_t prod) const noexcept {
+			assert(prod < productions.size());
+			return { symbols.data() + productions[prod].offset, productions[prod].length };
+		}
+		bool is_nullable(identifier_t sym) const noexcept {
+			return sym.is_nonterminal() && nullable[nonterminal_ordinal(sym)];
+		}
+		terminal_set_t first(identifier_t sym) const noexcept {
+			if (sym.is_nonterminal()) return first_sets[nonterminal_ordinal(sym)];
+			terminal_set_t set;
+			set.set(sym.index);
+			return set;
+		}
+		// FIRST of the rhs of `prod` from `step` on, empty past its end
+		terminal_set_t const& first_from(std::uint32_t prod, std::uint32_t step) const noexcept {
+			static terminal_set_t const empty;
+			if (step == productions[prod].length) return empty;
+			return suffix_first[productions[prod].offset + step];
+		}
+		bool nullable_from(std::uint32_t prod, std::uint32_t step) const noexcept {
+			return step == productions[prod].length || suffix_nullable[productions[prod].offset + step];
+		}
+		// the indices of the productions of `nt`
+		auto productions_of(identifier_t nt) const noexcept {
+			assert(nt.is_nonterminal() && nonterminal_ordinal(nt) + 1 < nonterminal_first.size());
+			return std::views::iota(nonterminal_first[nonterminal_ordinal(nt)], nonterminal_first[nonterminal_ordinal(nt) + 1]);
+		}
+	};
+	inline grammar_t grammar;
+
 	inline identifier_t get_terminal(std::string s) {
 		if (terminals.contains(s)) return { terminals.at(s) };
 		else {
@@ -49,7 +197,7 @@ namespace frontend {
 		}
 		void finalize(std::size_t i) {
 			if (i == option_set.size()) {
-				productions.emplace(lhs, buffer);
+				grammar.add(lhs, buffer);
 				return;
 			}
 			auto const& cur_group = rhs[i];
@@ -65,19 +213,22 @@ namespace frontend {
 			}
 		}
 		void parse_file(char const* grammar_file_name) {
-			// reuse scanner
 			fast_io::native_file_loader fl{ fast_io::mnp::os_c_str(grammar_file_name) };
-			scanner_t lex{ grammar_file_name, {fl.begin(), fl.end()} };
-			token_t token;
+			std::string_view const source{ fl.begin(), fl.end() };
+			// comments go to the trivia, so the grammar never sees them
+			trivia_t trivia;
+			auto const tokens = tokenize_all(source, grammar_file_name, {}, nullptr, &trivia);
 			bool unbalanced{};		
-			while ((token = lex.next_token()).tokenkind != token_e::L_EOF) {
+			for (std::size_t i{}; tokens.kind(i) != token_e::L_EOF; ++i) {
+				auto const kind = tokens.kind(i);
+				auto const text = tokens.text(source, i);
 				identifier_t ident;
-				if (token.tokenkind == token_e::IDENT && !(*token.begin == 'l' && *(token.begin + 1) == '_'))
-					ident = get_nonterminal(std::string{ token.begin, token.end });
+				if (kind == token_e::IDENT && !text.starts_with("l_"))
+					ident = get_nonterminal(std::string{ text });
 				else
-					ident = get_terminal(std::string{ token.begin, token.end });
+					ident = get_terminal(std::string{ text });
 				if (!is_parsing_rhs) {
-					if (token.tokenkind == token_e::ASSIGN) // '='
+					if (kind == token_e::ASSIGN) // '='
 						is_parsing_rhs = true;
 					else if (ident.is_nonterminal())
 						lhs = ident;
@@ -86,7 +237,7 @@ namespace frontend {
 					continue;
 				}
 				/*else*/
-				if (token.tokenkind == token_e::SEMICOLON) { // ';'
+				if (kind == token_e::SEMICOLON) { // ';'
 					if (unbalanced) {
 						rhs.pop_back();
 						unbalanced = false;
@@ -95,7 +246,7 @@ namespace frontend {
 					init();
 					is_parsing_rhs = false;
 				}
-				else if (token.tokenkind == token_e::BOR) { // '|'
+				else if (kind == token_e::BOR) { // '|'
 					if (unbalanced) {
 						rhs.pop_back();
 						unbalanced = false;
@@ -103,14 +254,14 @@ namespace frontend {
 					finalize(0);
 					init();
 				}
-				else if (token.tokenkind == token_e::LBRACKET) { // '['
+				else if (kind == token_e::LBRACKET) { // '['
 					option_set.push_back(1);
 					if (!unbalanced)
 						rhs.push_back({});
 					else
 						unbalanced = false;
 				}
-				else if (token.tokenkind ==token_e::RBRACKET) { // ']'
+				else if (kind == token_e::RBRACKET) { // ']'
 					rhs.push_back({});
 					unbalanced = true;
 				}
@@ -133,187 +284,337 @@ namespace frontend {
 			}
 			if (is_parsing_rhs)
 				panic("unexpected eof, possibly missing ';' at the end\n");
+			grammar.build();
 		}
 	};
 
 	inline void check_all_nonterminals_with_productions()
 	{
 		for (auto const& nt : nonterminals) {
-			auto [beg_itr, end_itr] = productions.equal_range(identifier_t{ nt.second });
-			if (beg_itr == productions.end())
+			if (grammar.productions_of(identifier_t{ nt.second }).empty())
 				panic("\"", nt.first, "\" don't have its production\n");
 		}
-		for (auto const& p : productions) {
-			if (p.second.size() == 0)
-				panic("\"", identifiers.at(p.first.index), "\"'s production is empty, which is not suportted\n");
+		for (auto const& p : grammar.productions) {
+			if (p.length == 0)
+				panic("\"", identifiers.at(p.lhs.index), "\"'s production is empty, which is not suportted\n");
+			if (p.length > max_production_length)
+				panic("\"", identifiers.at(p.lhs.index), "\"'s production is longer than ", max_production_length, ", which is not suportted\n");
 		}
+		if (grammar.productions.size() > max_production_cnt)
+			panic("too many productions!(> ", max_production_cnt, ")\n");
 	}
 
+	// An lr(0) item in 32 bits: the production index above step_bits, the dot position below.
+	// The items of a production are consecutive, so moving the dot is an increment. The
+	// lookaheads of an item are kept next to it by the state.
 	struct item_t {
-		identifier_t lhs;
-		decltype(std::to_address(productions.begin())) prod;
-		std::size_t step;
-		identifier_t lookahead;
-		bool operator==(item_t const& other) const noexcept = default;
-		bool same_core_with(item_t const& other) const noexcept {
-			return prod == other.prod && step == other.step;
+		std::uint32_t core;
+
+		static constexpr item_t make(std::uint32_t prod, std::uint32_t step) noexcept {
+			return { prod << item_step_bits | step };
+		}
+		auto operator<=>(item_t const& other) const noexcept = default;
+		// an index into grammar.productions
+		constexpr std::uint32_t prod() const noexcept {
+			return core >> item_step_bits;
+		}
+		constexpr std::uint32_t step() const noexcept {
+			return core & max_production_length;
+		}
+		// the item with the dot past the next symbol
+		constexpr item_t advanced() const noexcept {
+			return { core + 1 };
+		}
+		identifier_t lhs() const noexcept {
+			return grammar.productions[prod()].lhs;
 		}
 		bool is_reducable() const noexcept {
-			return step == prod->second.size();
+			return step() == grammar.productions[prod()].length;
 		}
 		bool is_shiftable() const noexcept {
 			return !is_reducable();
 		}
-		void pretty_print() const {
-			print(identifiers[lhs.index], " ->");
-			for (std::size_t i{}; i < step; ++i) {
-				print(" ", identifiers[prod->second.at(i).index]);
+		// the symbol after the dot
+		identifier_t next() const noexcept {
+			assert(is_shiftable());
+			return grammar.rhs(prod())[step()];
+		}
+		void pretty_print(terminal_set_t const& lookahead) const {
+			auto const rhs = grammar.rhs(prod());
+			print(identifiers[lhs().index], " ->");
+			for (std::size_t i{}; i < step(); ++i) {
+				print(" ", identifiers[rhs[i].index]);
 			}
 			print(" .");
-			for (std::size_t i{ step }; i < prod->second.size(); ++i) {
-				print(" ", identifiers[prod->second.at(i).index]);
+			for (std::size_t i{ step() }; i < rhs.size(); ++i) {
+				print(" ", identifiers[rhs[i].index]);
 			}
-			println("\t, ", identifiers[lookahead.index]);
+			print("\t,");
+			for_each_terminal(lookahead, [](identifier_t t) { print(" ", identifiers[t.index]); });
+			println("");
 		}
 	};
 
-	inline void first(identifier_t other, std::unordered_set<identifier_t>& lookahead) noexcept {
-		if (other.is_terminal()) {
-			lookahead.insert(other);
-			return;
-		}
-		// else
-		auto [beg_itr, end_itr] = productions.equal_range(other);
-		for (; beg_itr != end_itr; ++beg_itr) {
-			// if a production is directly left recurssive
-			// then it will contribute no first element
-			if (beg_itr->second[0] == other)
-				continue;
-			else
-				first(beg_itr->second[0], lookahead);
-		}
-	}
-
 	struct state_t {
-		std::vector<item_t> items;
 		// a state is viewed as some basic items and the items that are derived from the former
 		// the cnt to note which are the basic items
-		// the first {cnt} items are basic
-		// considering this, the items can't be stored in std::set
+		// the first {cnt} items are basic, sorted once the state is made
+		// every item is in a state once, with all its lookaheads
+		std::vector<item_t> items;
+		// the lookaheads of items[i]
+		std::vector<terminal_set_t> lookaheads;
 		std::size_t cnt;
 		std::unordered_map<identifier_t, std::size_t> next;
 	};
+	inline std::span<item_t const> kernel(state_t const& s) noexcept {
+		return { s.items.data(), s.cnt };
+	}
+	inline void sort_kernel(state_t& s) {
+		std::vector<std::pair<item_t, terminal_set_t>> kernel_items(s.cnt);
+		for (std::size_t i{}; i < s.cnt; ++i) {
+			kernel_items[i] = { s.items[i], s.lookaheads[i] };
+		}
+		std::ranges::sort(kernel_items, {}, [](auto const& k) { return k.first; });
+		for (std::size_t i{}; i < s.cnt; ++i) {
+			std::tie(s.items[i], s.lookaheads[i]) = kernel_items[i];
+		}
+	}
+	// whether the kernels hold the same items, whatever their lookaheads
+	inline bool same_core_with(state_t const& lhs, state_t const& rhs) noexcept {
+		return lhs.cnt == rhs.cnt && std::memcmp(lhs.items.data(), rhs.items.data(), lhs.cnt * sizeof(item_t)) == 0;
+	}
 	inline bool operator==(state_t const& lhs, state_t const& rhs) noexcept {
-		if (lhs.cnt != rhs.cnt) return false;
-		for (std::size_t i{}; i < lhs.cnt; ++i) {
-			for (std::size_t j{}; j < lhs.cnt; ++j) {
-				if (lhs.items[i] == rhs.items[j]) goto SUCCESS;
+		return same_core_with(lhs, rhs) && std::equal(lhs.lookaheads.begin(), lhs.lookaheads.begin() + lhs.cnt, rhs.lookaheads.begin());
+	}
+
+	namespace details {
+		inline std::uint64_t hash_mix(std::uint64_t h, std::uint64_t v) noexcept {
+			constexpr std::uint64_t k = 0x9e37'79b9'7f4a'7c15;
+			return std::rotl((h ^ v) * k, 29);
+		}
+	}
+	// states with the same core hash the same
+	inline std::uint64_t core_hash(state_t const& s) noexcept {
+		std::uint64_t h{ s.cnt };
+		for (auto item : kernel(s))
+			h = details::hash_mix(h, item.core);
+		return h;
+	}
+	// equal states hash the same
+	inline std::uint64_t kernel_hash(state_t const& s) noexcept {
+		auto h = core_hash(s);
+		for (std::size_t i{}; i < s.cnt; ++i)
+			h = details::hash_mix(h, std::hash<terminal_set_t>{}(s.lookaheads[i]));
+		return h;
+	}
+
+	using project_t = std::vector<state_t>;
+	// the states by kernel_hash, only states on a hash hit are compared
+	using kernel_index_t = std::unordered_multimap<std::uint64_t, std::size_t>;
+
+	// the index of the state with the kernel of `s`, which is added if there is none
+	inline std::size_t find_or_add_state(project_t& c, kernel_index_t& kernel_index, state_t&& s)
+	{
+		s.cnt = s.items.size();
+		sort_kernel(s);
+		auto const hash = kernel_hash(s);
+		auto [same_hash, same_hash_end] = kernel_index.equal_range(hash);
+		for (; same_hash != same_hash_end; ++same_hash) {
+			if (s == c[same_hash->second])
+				return same_hash->second;
+		}
+		kernel_index.emplace(hash, c.size());
+		c.push_back(std::move(s));
+		return c.size() - 1;
+	}
+
+	// what closing a state needs, kept between states
+	struct closure_scratch_t {
+		static constexpr std::uint32_t no_item = static_cast<std::uint32_t>(-1);
+		// where the item at the start of a production is in the state, if it is
+		std::vector<std::uint32_t> item_of = std::vector<std::uint32_t>(grammar.productions.size(), no_item);
+		std::vector<std::uint32_t> worklist;
+	};
+	// adds the items derived from the kernel of `s`. With `with_lookaheads`, the lookaheads
+	// of an item are ORed into the items it derives, until they no longer grow; else the
+	// lookaheads are left empty, the lr(0) closure.
+	inline void close_state(state_t& s, closure_scratch_t& scratch, bool with_lookaheads = true)
+	{
+		auto& item_of = scratch.item_of;
+		auto& worklist = scratch.worklist;
+		worklist.clear();
+		for (std::uint32_t j{}; j < s.cnt; ++j) {
+			if (s.items[j].step() == 0) item_of[s.items[j].prod()] = j;
+			worklist.push_back(j);
+		}
+		while (!worklist.empty()) {
+			auto const j = worklist.back();
+			worklist.pop_back();
+			auto const item = s.items[j];
+			if (item.is_reducable() || item.next().is_terminal()) continue;
+			// FIRST of what follows, and the item's own lookaheads if all that is nullable
+			terminal_set_t lookahead;
+			if (with_lookaheads) {
+				lookahead = grammar.first_from(item.prod(), item.step() + 1);
+				if (grammar.nullable_from(item.prod(), item.step() + 1))
+					lookahead |= s.lookaheads[j];
+			}
+			for (auto p : grammar.productions_of(item.next())) {
+				if (item_of[p] == closure_scratch_t::no_item) {
+					item_of[p] = static_cast<std::uint32_t>(s.items.size());
+					s.items.push_back(item_t::make(p, 0));
+					s.lookaheads.push_back(lookahead);
+					worklist.push_back(item_of[p]);
+					continue;
+				}
+				auto& to = s.lookaheads[item_of[p]];
+				if ((to | lookahead) == to) continue;
+				to |= lookahead;
+				worklist.push_back(item_of[p]);
 			}
-			return false;
-		SUCCESS:; // continue
 		}
-		return true;
+		for (auto item : s.items) {
+			if (item.step() == 0) item_of[item.prod()] = closure_scratch_t::no_item;
+		}
 	}
-	inline bool same_core_with_helper(state_t const& lhs, state_t const& rhs) noexcept {
-		if (lhs.cnt != rhs.cnt) return false;
-		for (std::size_t i{}; i < lhs.cnt; ++i) {
-			for (std::size_t j{}; j < lhs.cnt; ++j) {
-				if (lhs.items[i].same_core_with(rhs.items[j])) goto SUCCESS;
+
+	// adds the states the closed state i goes to, by each symbol after a dot
+	inline void add_next_states(project_t& c, kernel_index_t& kernel_index, std::size_t i)
+	{
+		// the items that can pass a symbol, grouped by the symbol
+		std::vector<std::pair<identifier_t, std::uint32_t>> moves;
+		for (std::uint32_t j{}; j < c[i].items.size(); ++j) {
+			if (c[i].items[j].is_shiftable()) moves.push_back({ c[i].items[j].next(), j });
+		}
+		std::ranges::stable_sort(moves, {}, [](auto const& m) { return m.first; });
+		for (std::size_t begin{}, end{}; begin < moves.size(); begin = end) {
+			auto const ident = moves[begin].first;
+			state_t tmp_state;
+			for (end = begin; end < moves.size() && moves[end].first == ident; ++end) {
+				tmp_state.items.push_back(c[i].items[moves[end].second].advanced());
+				tmp_state.lookaheads.push_back(c[i].lookaheads[moves[end].second]);
 			}
-			return false;
-		SUCCESS:; // continue
+			// whether tmp_state is equal to a previous state is judged first
+			auto const next_state = find_or_add_state(c, kernel_index, std::move(tmp_state));
+			c[i].next.insert({ ident, next_state });
 		}
-		return true;
 	}
-	inline bool same_core_with(state_t const& lhs, state_t const& rhs) noexcept {
-		return same_core_with_helper(lhs, rhs) && same_core_with_helper(lhs, rhs);
+
+	// the first state, every production of the start symbol, followed by `lookahead`
+	inline project_t make_start_state(terminal_set_t const& lookahead)
+	{
+		project_t c(1);
+		for (auto p : grammar.productions_of(grammar.start)) {
+			c[0].items.push_back(item_t::make(p, 0));
+			c[0].lookaheads.push_back(lookahead);
+		}
+		c[0].cnt = c[0].items.size();
+		sort_kernel(c[0]);
+		return c;
 	}
 
-	using project_t = std::vector<state_t>;
+	// a state per lr(1) kernel
+	inline project_t make_canonical_project()
+	{
+		// followed by eof
+		auto c = make_start_state(terminal_set_t{}.set(0));
+		kernel_index_t kernel_index{ { kernel_hash(c[0]), 0 } };
+		closure_scratch_t scratch;
+		for (std::size_t i{}; i < c.size(); ++i) {
+			close_state(c[i], scratch);
+			add_next_states(c, kernel_index, i);
+		}
+		return c;
+	}
 
-	project_t make_project() noexcept
+	// The lr(0) states, with the lookaheads of lr(1) found by spontaneous generation and
+	// propagation. Closing a kernel item with the lookahead propagated_lookahead shows the
+	// lookaheads its successors get whatever it has, and the kernel items it passes its own
+	// to. Then the lookaheads flow along these until nothing changes.
+	inline project_t make_lalr_project()
 	{
-		project_t c = { state_t{{item_t{productions.begin()->first, std::to_address(productions.begin()), 0, {{0}}}}, 1, {}} };
+		auto c = make_start_state({});
+		kernel_index_t kernel_index{ { kernel_hash(c[0]), 0 } };
+		closure_scratch_t scratch;
 		for (std::size_t i{}; i < c.size(); ++i) {
-			auto& cur_state = c[i];
-			auto& cur_items = cur_state.items;
-			std::unordered_set<identifier_t> handled_identifiers;
-			for (std::size_t j{}; j < cur_items.size(); ++j) {
-				auto const& item_ref = cur_items[j];
-				if (item_ref.is_reducable()) continue;
-				auto const& next_identifier = item_ref.prod->second.at(item_ref.step);
-				handled_identifiers.insert(next_identifier);
-				if (next_identifier.is_terminal()) continue;
-				// is nonterminal
-				// need to add the related production
-				auto [prod_beg_itr, prod_end_itr] = productions.equal_range(next_identifier);
-				// generate item for each lookahead identifier
-				auto apply = [&, cur_items_size = cur_items.size()](identifier_t lookahead) {
-					for (; prod_beg_itr != prod_end_itr; ++prod_beg_itr) {
-						// pushback items that do not exist
-						// assert during every path, the newly added items don't repeat
-						item_t tmp_item{ next_identifier, std::to_address(prod_beg_itr), 0, lookahead };
-						for (std::size_t i{}; i < cur_items_size; ++i) {
-							if (tmp_item == cur_items[i]) return;
-						}
-						cur_items.push_back(std::move(tmp_item));
-					}
-				};
-				// first(NULL) == NULL, so the lookahead is inheritated
-				if (item_ref.step == item_ref.prod->second.size() - 1) {
-					apply(item_ref.lookahead);
-				}
-				else {
-					std::unordered_set<identifier_t> lookahead;
-					first(item_ref.prod->second.at(item_ref.step + 1), lookahead);
-					if (lookahead.contains({ 0 })) {
-						lookahead.insert(item_ref.lookahead);
+			close_state(c[i], scratch, false);
+			add_next_states(c, kernel_index, i);
+		}
+
+		// the k-th kernel item of state i is kernel_first[i] + k
+		std::vector<std::size_t> kernel_first(c.size() + 1);
+		for (std::size_t i{}; i < c.size(); ++i) {
+			kernel_first[i + 1] = kernel_first[i] + c[i].cnt;
+		}
+		std::vector<terminal_set_t> lookaheads(kernel_first.back());
+		std::vector<std::vector<std::size_t>> propagate_to(kernel_first.back());
+		// the start items are followed by eof
+		for (std::size_t k{}; k < c[0].cnt; ++k) {
+			lookaheads[k].set(0);
+		}
+		state_t single;
+		for (std::size_t i{}; i < c.size(); ++i) {
+			for (std::size_t k{}; k < c[i].cnt; ++k) {
+				single.items.assign(1, c[i].items[k]);
+				single.lookaheads.assign(1, terminal_set_t{}.set(propagated_lookahead));
+				single.cnt = 1;
+				close_state(single, scratch);
+				for (std::size_t j{}; j < single.items.size(); ++j) {
+					if (single.items[j].is_reducable()) continue;
+					auto const next_state = c[i].next.at(single.items[j].next());
+					auto const next_kernel = kernel(c[next_state]);
+					auto const to = kernel_first[next_state]
+						+ (std::ranges::lower_bound(next_kernel, single.items[j].advanced()) - next_kernel.begin());
+					auto lookahead = single.lookaheads[j];
+					if (lookahead.test(propagated_lookahead)) {
+						lookahead.reset(propagated_lookahead);
+						propagate_to[kernel_first[i] + k].push_back(to);
 					}
-					std::ranges::for_each(lookahead, apply);
+					lookaheads[to] |= lookahead;
 				}
 			}
-			// produce next state(s)
-			// 0 for unhandled, 1 for used
-			std::vector<std::uint8_t> handled_items(cur_items.size());
-			c.reserve(c.size() + handled_identifiers.size());
-			auto& updated_items = c[i].items;
-			for (auto const& ident : handled_identifiers) {
-				state_t tmp_state;
-				for (std::size_t j{}; j < handled_items.size(); ++j) {
-					if (handled_items[j]) continue;
-					auto const& cur_item = updated_items[j];
-					if (cur_item.is_reducable()) {
-						handled_items[j] = true;
-						continue;
-					}
-					if (ident != cur_item.prod->second.at(cur_item.step)) continue;
-					// now the item can pass the identifier i to the following item
-					item_t tmp_item = cur_item;
-					++tmp_item.step;
-					tmp_state.items.push_back(std::move(tmp_item));
-					handled_items[j] = true;
-				}
-				tmp_state.cnt = tmp_state.items.size();
-				// before doing these two
-				// cur_state.next.insert({ i, c.end() });
-				// c.push_back(state_t{ tmp_state, {} });
-				// whether tmp_state is equal to the previous state should be judged first.
-				for (auto c_itr = c.begin(); c_itr != c.end(); ++c_itr) {
-					if (tmp_state == *c_itr) {
-						c[i].next.insert({ ident, c_itr - c.begin() });
-						goto NEXT_LOOP;
-					}
-				}
-				{
-					c[i].next.insert({ ident, c.size() });
-					c.push_back(std::move(tmp_state));
+		}
+		// 0 for not queued, 1 for queued
+		std::vector<std::uint8_t> queued(lookaheads.size(), 1);
+		std::vector<std::size_t> propagate_worklist(lookaheads.size());
+		for (std::size_t i{}; i < propagate_worklist.size(); ++i) {
+			propagate_worklist[i] = i;
+		}
+		while (!propagate_worklist.empty()) {
+			auto const from = propagate_worklist.back();
+			propagate_worklist.pop_back();
+			queued[from] = false;
+			for (auto to : propagate_to[from]) {
+				if ((lookaheads[to] | lookaheads[from]) == lookaheads[to]) continue;
+				lookaheads[to] |= lookaheads[from];
+				if (!queued[to]) {
+					queued[to] = true;
+					propagate_worklist.push_back(to);
 				}
-			NEXT_LOOP:;
 			}
 		}
+
+		// the lr(1) items of the states
+		for (std::size_t i{}; i < c.size(); ++i) {
+			c[i].items.resize(c[i].cnt);
+			c[i].lookaheads.assign(lookaheads.begin() + kernel_first[i], lookaheads.begin() + kernel_first[i + 1]);
+			close_state(c[i], scratch);
+		}
 		return c;
 	}
 
+	enum class lr_mode_e : std::uint8_t {
+		// the lr(0) states with lr(1) lookaheads
+		LALR,
+		// a state per lr(1) kernel, for grammars that are lr(1) but not lalr(1). make_table
+		// still combines the states it can.
+		CANONICAL,
+	};
+	inline project_t make_project(lr_mode_e mode = lr_mode_e::LALR)
+	{
+		return mode == lr_mode_e::LALR ? make_lalr_project() : make_canonical_project();
+	}
+
 	enum class action_e : std::uint8_t {
 		ERROR = 0,
 		SHIFT,
@@ -325,7 +626,8 @@ namespace frontend {
 		action_e action;
 		union {
 			std::size_t state;
-			decltype(std::to_address(productions.begin())) prod;
+			// an index into grammar.productions
+			std::uint32_t prod;
 		} des;
 		using act_t = void(*)(void);
 		act_t other_act;
@@ -391,7 +693,7 @@ namespace frontend {
 			return goto_table[row * nonterminal_cnt + col];
 		}
 		auto& goto_table_at(std::size_t row, identifier_t col) noexcept {
-			return goto_table_at(row, col.index & 0x7fff'ffff'ffff'ffff);
+			return goto_table_at(row, nonterminal_ordinal(col));
 		}
 		auto action_table_at(std::size_t row) const noexcept {
 			return action_table + row * terminal_cnt;
@@ -409,13 +711,14 @@ namespace frontend {
 			return goto_table[row * nonterminal_cnt + col];
 		}
 		auto const& goto_table_at(std::size_t row, identifier_t col) const noexcept {
-			return goto_table_at(row, col.index & 0x7fff'ffff'ffff'ffff);
+			return goto_table_at(row, nonterminal_ordinal(col));
 		}
 	};
 
 	inline table_t make_table(project_t const& c)
 	{
-		table_t table{ terminals.size(), nonterminals.size(), c.size() };
+		// terminals are token_e values, and some values below operator_end name no terminal
+		table_t table{ std::to_underlying(token_e::operator_end), nonterminals.size(), c.size() };
 		std::size_t i{};
 		for (auto const& s : c) {
 			for (auto const& cur_ident : s.next) {
@@ -424,12 +727,14 @@ namespace frontend {
 				else
 					table.goto_table_at(i, cur_ident.first) = { .des = cur_ident.second };
 			}
-			for (auto const& cur_item : s.items) {
-				if (!cur_item.is_reducable()) continue;
-				auto& action_table_unit = table.action_table_at(i, cur_item.lookahead);
-				if (action_table_unit.action != action_e::ERROR)
-					panic("shift-reduce conflict!");
-				action_table_unit = { action_e::REDUCE, {.prod = cur_item.prod}, nullptr };
+			for (std::size_t j{}; j < s.items.size(); ++j) {
+				if (!s.items[j].is_reducable()) continue;
+				for_each_terminal(s.lookaheads[j], [&](identifier_t lookahead) {
+					auto& action_table_unit = table.action_table_at(i, lookahead);
+					if (action_table_unit.action != action_e::ERROR)
+						panic("shift-reduce conflict!");
+					action_table_unit = { action_e::REDUCE, {.prod = s.items[j].prod()}, nullptr };
+				});
 			}
 			++i;
 		}
@@ -437,13 +742,21 @@ namespace frontend {
 		// that is, all items in it except for their lookahead set are the same
 		// then the 2 states with the same core may be combined into 1 state when
 		// the 2 lines in the table doesn't interfere with each other.
+		// the state each state is combined into, itself if it is not
 		std::vector<std::size_t> redirect_table(table.state_cnt);
 		for (std::size_t i{}; i < table.state_cnt; ++i) {
 			redirect_table[i] = i;
 		}
-		std::size_t new_state_cnt{ table.state_cnt };
+		// only states with the same core_hash are candidates, in increasing order
+		std::unordered_map<std::uint64_t, std::vector<std::size_t>> core_index;
 		for (std::size_t i{}; i < table.state_cnt; ++i) {
-			for (std::size_t j{ i + 1 }; j < table.state_cnt; ++j) {
+			core_index[core_hash(c[i])].push_back(i);
+		}
+		for (std::size_t i{}; i < table.state_cnt; ++i) {
+			// already combined into an earlier state
+			if (redirect_table[i] != i) continue;
+			for (auto const j : core_index[core_hash(c[i])]) {
+				if (j <= i || redirect_table[j] != j) continue;
 				if (!same_core_with(c[i], c[j]))
 					goto NEXT_LOOP_FOR_J;
 				// else
@@ -480,7 +793,6 @@ namespace frontend {
 				// has no conflict
 				// do 1. combine 2 lines
 				//	  2. record the redirect table
-				//	  3. --new_state_cnt
 				for (std::size_t te_index{}; te_index < table.terminal_cnt; ++te_index) {
 					if (auto const& table_unit_j = table.action_table_at(j, te_index);
 						table_unit_j.action != action_e::ERROR) {
@@ -493,14 +805,19 @@ namespace frontend {
 						table.goto_table_at(i, nt_index) = table_unit_j;
 					}
 				}
-				redirect_table[j] = redirect_table[i];
-				for (std::size_t k{ j + 1 }; k < table.state_cnt; ++k)
-					--redirect_table[k];
-				--new_state_cnt;
+				redirect_table[j] = i;
 			NEXT_LOOP_FOR_J:;
 			}
 		}
-		++new_state_cnt;
+		// the states left are numbered in order
+		std::vector<std::size_t> new_index(table.state_cnt);
+		std::size_t new_state_cnt{};
+		for (std::size_t i{}; i < table.state_cnt; ++i) {
+			if (redirect_table[i] == i) new_index[i] = new_state_cnt++;
+		}
+		for (auto& to_i : redirect_table) {
+			to_i = new_index[to_i];
+		}
 		table_t new_table{ table.terminal_cnt, table.nonterminal_cnt, new_state_cnt };
 		struct vector_bool {
 			std::uint8_t* data;
@@ -539,6 +856,15 @@ namespace frontend {
 			if (copied[to_i]) continue;
 			std::memcpy(new_table.action_table_at(to_i), table.action_table_at(from_i), sizeof(action_table_unit_t) * table.terminal_cnt);
 			std::memcpy(new_table.goto_table_at(to_i), table.goto_table_at(from_i), sizeof(goto_table_unit_t) * table.nonterminal_cnt);
+			// and the destinations
+			for (std::size_t te_index{}; te_index < table.terminal_cnt; ++te_index) {
+				if (auto& table_unit = new_table.action_table_at(to_i, te_index); table_unit.action == action_e::SHIFT)
+					table_unit.des.state = redirect_table[table_unit.des.state];
+			}
+			for (std::size_t nt_index{}; nt_index < table.nonterminal_cnt; ++nt_index) {
+				if (auto& table_unit = new_table.goto_table_at(to_i, nt_index); table_unit.des != static_cast<std::size_t>(-1))
+					table_unit.des = redirect_table[table_unit.des];
+			}
 			copied[to_i] = true;
 		}
 		return new_table;
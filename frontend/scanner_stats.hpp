@@ -0,0 +1,175 @@
+#pragma once
+#include "../utils.hpp"
+
+// Counters of what a scanner spends its time on, kept by scanners whose policy asks for
+// them. The others keep an empty no_scanner_stats_t and have no counting code at all.
+namespace frontend {
+	enum class stats_e : std::uint8_t {
+		NONE,
+		// tokens and bytes per kind, and the paths taken through numbers and comments
+		COUNT,
+		// COUNT, and a histogram of the cycles each token took, per kind. reading the time
+		// stamp counter twice a token costs about as much as lexing a short one.
+		CYCLES,
+	};
+
+	// how a number literal was lexed, at the branch of consume_number it left by
+	enum class number_path_e : std::uint8_t {
+		// "0", also when it is followed by a 'b' or 'x' that does not start a literal
+		ZERO,
+		BINARY,
+		HEX,
+		HEX_EXPONENT,
+		HEX_FRACTION,
+		ZERO_FRACTION,
+		OCTAL,
+		OCTAL_FRACTION,
+		OCTAL_EXPONENT,
+		// a decimal float started by '0' and a digit past '7'
+		LEADING_ZERO,
+		DECIMAL,
+		DECIMAL_FRACTION,
+		DECIMAL_EXPONENT,
+		// ".5", through consume_dot
+		DOT_FRACTION,
+		ERROR,
+		count,
+	};
+	inline constexpr std::array<char const*, std::to_underlying(number_path_e::count)> number_path_names{
+		"zero", "binary", "hex", "hex_exponent", "hex_fraction", "zero_fraction", "octal", "octal_fraction",
+		"octal_exponent", "leading_zero", "decimal", "decimal_fraction", "decimal_exponent", "dot_fraction", "error",
+	};
+	enum class comment_path_e : std::uint8_t {
+		LINE,
+		BLOCK,
+		UNTERMINATED_BLOCK,
+		count,
+	};
+	inline constexpr std::array<char const*, std::to_underlying(comment_path_e::count)> comment_path_names{
+		"line", "block", "unterminated_block",
+	};
+
+	inline std::uint64_t read_cycles() noexcept {
+#ifdef FRONTEND_SIMD_X86
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	struct scanner_stats_t {
+		// every token_e but ILLEGAL, which is counted after them
+		static constexpr std::size_t kind_cnt = std::to_underlying(token_e::operator_end) + 1;
+		// bucket i holds the tokens that took [2^(i-1), 2^i) cycles, bucket 0 those that took none
+		static constexpr std::size_t cycle_bucket_cnt = 32;
+
+		std::array<std::uint64_t, kind_cnt> tokens{};
+		// of lexemes, quotes and '#' runs included
+		std::array<std::uint64_t, kind_cnt> bytes{};
+		std::array<std::uint64_t, std::to_underlying(number_path_e::count)> number_paths{};
+		std::array<std::uint64_t, std::to_underlying(comment_path_e::count)> comment_paths{};
+		// empty unless lexed with stats_e::CYCLES
+		std::array<std::array<std::uint64_t, cycle_bucket_cnt>, kind_cnt> cycles{};
+
+		static constexpr std::size_t kind_index(token_e kind) noexcept {
+			return kind == token_e::ILLEGAL ? kind_cnt - 1 : std::to_underlying(kind);
+		}
+		static constexpr token_e index_kind(std::size_t i) noexcept {
+			return i == kind_cnt - 1 ? token_e::ILLEGAL : token_e{ i };
+		}
+
+		void count_token(token_e kind, std::size_t length) noexcept {
+			++tokens[kind_index(kind)];
+			bytes[kind_index(kind)] += length;
+		}
+		void count_cycles(token_e kind, std::uint64_t n) noexcept {
+			++cycles[kind_index(kind)][std::min<std::size_t>(std::bit_width(n), cycle_bucket_cnt - 1)];
+		}
+		void count(number_path_e path) noexcept {
+			++number_paths[std::to_underlying(path)];
+		}
+		void count(comment_path_e path) noexcept {
+			++comment_paths[std::to_underlying(path)];
+		}
+
+		std::uint64_t token_count(token_e kind) const noexcept {
+			return tokens[kind_index(kind)];
+		}
+		std::uint64_t byte_count(token_e kind) const noexcept {
+			return bytes[kind_index(kind)];
+		}
+		std::uint64_t path_count(number_path_e path) const noexcept {
+			return number_paths[std::to_underlying(path)];
+		}
+		std::uint64_t path_count(comment_path_e path) const noexcept {
+			return comment_paths[std::to_underlying(path)];
+		}
+		std::span<std::uint64_t const, cycle_bucket_cnt> cycle_histogram(token_e kind) const noexcept {
+			return cycles[kind_index(kind)];
+		}
+		std::uint64_t total_tokens() const noexcept {
+			std::uint64_t n{};
+			for (auto c : tokens) n += c;
+			return n;
+		}
+		std::uint64_t total_bytes() const noexcept {
+			std::uint64_t n{};
+			for (auto c : bytes) n += c;
+			return n;
+		}
+		// the kinds that were seen, most bytes first
+		std::vector<token_e> kinds_by_bytes() const {
+			std::vector<token_e> kinds;
+			for (std::size_t i{}; i < kind_cnt; ++i)
+				if (tokens[i] != 0) kinds.push_back(index_kind(i));
+			std::ranges::stable_sort(kinds, std::greater{}, [this](token_e k) { return byte_count(k); });
+			return kinds;
+		}
+
+		// adds the counts of another scanner, e.g. one of another thread
+		void merge(scanner_stats_t const& other) noexcept {
+			for (std::size_t i{}; i < kind_cnt; ++i) {
+				tokens[i] += other.tokens[i];
+				bytes[i] += other.bytes[i];
+				for (std::size_t b{}; b < cycle_bucket_cnt; ++b)
+					cycles[i][b] += other.cycles[i][b];
+			}
+			for (std::size_t i{}; i < number_paths.size(); ++i) number_paths[i] += other.number_paths[i];
+			for (std::size_t i{}; i < comment_paths.size(); ++i) comment_paths[i] += other.comment_paths[i];
+		}
+		void clear() noexcept {
+			*this = {};
+		}
+
+		// prints every kind seen, most bytes first, then the paths taken and the cycle
+		// histograms. kinds are named by `identifiers` once init_terminal_identifiers() ran.
+		void dump() const {
+			auto const total = total_bytes();
+			auto const name = [](token_e kind) -> std::string {
+				if (kind == token_e::ILLEGAL) return "illegal";
+				auto itr = identifiers.find(std::to_underlying(kind));
+				return itr != identifiers.end() ? itr->second : fast_io::concat("token ", std::to_underlying(kind));
+			};
+			println("kind\ttokens\tbytes\tpercent of bytes");
+			for (auto kind : kinds_by_bytes())
+				println(name(kind), "\t", token_count(kind), "\t", byte_count(kind), "\t",
+					total == 0 ? 0.0 : 100.0 * static_cast<double>(byte_count(kind)) / static_cast<double>(total));
+			println("number path\ttokens");
+			for (std::size_t i{}; i < number_paths.size(); ++i)
+				if (number_paths[i] != 0) println(fast_io::mnp::os_c_str(number_path_names[i]), "\t", number_paths[i]);
+			println("comment path\ttokens");
+			for (std::size_t i{}; i < comment_paths.size(); ++i)
+				if (comment_paths[i] != 0) println(fast_io::mnp::os_c_str(comment_path_names[i]), "\t", comment_paths[i]);
+			for (auto kind : kinds_by_bytes()) {
+				auto histogram = cycle_histogram(kind);
+				if (std::ranges::all_of(histogram, [](std::uint64_t n) { return n == 0; })) continue;
+				println("cycles of ", name(kind));
+				for (std::size_t b{}; b < cycle_bucket_cnt; ++b)
+					if (histogram[b] != 0)
+						println("\t< ", std::uint64_t{ 1 } << b, "\t", histogram[b]);
+			}
+		}
+	};
+	// what a scanner without stats keeps, nothing
+	struct no_scanner_stats_t {};
+} // namespace frontend
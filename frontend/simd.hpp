@@ -0,0 +1,492 @@
+#pragma once
+#include "../utils.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define FRONTEND_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define FRONTEND_TARGET_AVX2
+#else
+#define FRONTEND_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Byte-class kernels used by the scanner's hot loops.
+// Whitespace and identifier runs are short, so they use SSE2 (baseline on x86-64) inline.
+// Strings, raw strings, block comments and newline scans may be long, so they go through a table
+// selected once at start-up: AVX2 if the cpu has it, then SSE2, then the scalar fallback.
+// UTF-8 validation is one such pass over a whole file, done before it is lexed.
+namespace frontend::simd {
+	inline constexpr bool is_inline_space(char c) noexcept {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+	}
+	inline constexpr bool is_identifier_char(char c) noexcept {
+		return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+	}
+
+	// the end of a token that may span lines, with the lines it spans
+	struct comment_end_t {
+		// points at the closing delimiter, the '*' of "*/" or the '`', or at end if there is none
+		char const* pos;
+		std::size_t newlines;
+		// the last '\n' before pos, nullptr if there is none
+		char const* last_newline;
+	};
+
+	namespace scalar {
+		inline char const* find_string_special(char const* p, char const* end) noexcept {
+			while (p < end && *p != '"' && *p != '\\' && *p != '\n') ++p;
+			return p;
+		}
+		inline comment_end_t find_comment_end(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			for (; p + 1 < end; ++p) {
+				if (*p == '\n') {
+					++r.newlines;
+					r.last_newline = p;
+				}
+				else if (*p == '*' && p[1] == '/') {
+					r.pos = p;
+					return r;
+				}
+			}
+			if (p < end && *p == '\n') {
+				++r.newlines;
+				r.last_newline = p;
+			}
+			return r;
+		}
+		inline comment_end_t find_backquote(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			for (; p < end; ++p) {
+				if (*p == '\n') {
+					++r.newlines;
+					r.last_newline = p;
+				}
+				else if (*p == '`') {
+					r.pos = p;
+					break;
+				}
+			}
+			return r;
+		}
+		inline void collect_line_starts(char const* p, char const* end, std::uint32_t base, std::vector<std::uint32_t>& out) {
+			for (auto q = p; q < end; ++q) {
+				if (*q == '\n')
+					out.push_back(base + static_cast<std::uint32_t>(q - p) + 1);
+			}
+		}
+		inline char const* find_invalid_utf8(char const* p, char const* end) noexcept {
+			while (p < end) {
+				if (static_cast<unsigned char>(*p) < 0x80) {
+					++p;
+					continue;
+				}
+				auto n = unicode::decode(p, end).length;
+				if (n == 0) return p;
+				p += n;
+			}
+			return p;
+		}
+	} // namespace scalar
+
+#ifdef FRONTEND_SIMD_X86
+	namespace sse2 {
+		inline std::uint32_t space_mask(__m128i v) noexcept {
+			// ' ' or '\t' '\v' '\f' '\r' (9..13 except '\n')
+			auto ctrl = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(8)), _mm_cmplt_epi8(v, _mm_set1_epi8(14)));
+			ctrl = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), ctrl);
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')))));
+		}
+		inline std::uint32_t identifier_mask(__m128i v) noexcept {
+			// bytes >= 0x80 are negative, so they fall out of every signed range below
+			auto lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+			auto alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+			auto digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+			auto under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), under)));
+		}
+		inline char const* skip_inline_space(char const* p, char const* end) noexcept {
+			for (; end - p >= 16; p += 16) {
+				auto mask = ~space_mask(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))) & 0xffff;
+				if (mask) return p + std::countr_zero(mask);
+			}
+			while (p < end && is_inline_space(*p)) ++p;
+			return p;
+		}
+		inline char const* skip_identifier(char const* p, char const* end) noexcept {
+			for (; end - p >= 16; p += 16) {
+				auto mask = ~identifier_mask(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))) & 0xffff;
+				if (mask) return p + std::countr_zero(mask);
+			}
+			while (p < end && is_identifier_char(*p)) ++p;
+			return p;
+		}
+		inline char const* find_string_special(char const* p, char const* end) noexcept {
+			for (; end - p >= 16; p += 16) {
+				auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+				auto hit = _mm_or_si128(_mm_or_si128(
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+				if (auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(hit)))
+					return p + std::countr_zero(mask);
+			}
+			return scalar::find_string_special(p, end);
+		}
+		inline comment_end_t find_comment_end(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			// the second load reads p[16], so keep one byte of slack
+			for (; end - p > 16; p += 16) {
+				auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+				auto next = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + 1));
+				auto close = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+					_mm_cmpeq_epi8(v, _mm_set1_epi8('*')), _mm_cmpeq_epi8(next, _mm_set1_epi8('/')))));
+				auto newline = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+				if (close) {
+					auto pos = std::countr_zero(close);
+					newline &= (1u << pos) - 1;
+					r.pos = p + pos;
+					if (newline) {
+						r.newlines += std::popcount(newline);
+						r.last_newline = p + 31 - std::countl_zero(newline);
+					}
+					return r;
+				}
+				if (newline) {
+					r.newlines += std::popcount(newline);
+					r.last_newline = p + 31 - std::countl_zero(newline);
+				}
+			}
+			auto tail = scalar::find_comment_end(p, end);
+			r.pos = tail.pos;
+			r.newlines += tail.newlines;
+			if (tail.last_newline) r.last_newline = tail.last_newline;
+			return r;
+		}
+		inline comment_end_t find_backquote(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			for (; end - p >= 16; p += 16) {
+				auto v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+				auto close = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('`'))));
+				auto newline = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+				if (close) {
+					auto pos = std::countr_zero(close);
+					newline &= (1u << pos) - 1;
+					r.pos = p + pos;
+					if (newline) {
+						r.newlines += std::popcount(newline);
+						r.last_newline = p + 31 - std::countl_zero(newline);
+					}
+					return r;
+				}
+				if (newline) {
+					r.newlines += std::popcount(newline);
+					r.last_newline = p + 31 - std::countl_zero(newline);
+				}
+			}
+			auto tail = scalar::find_backquote(p, end);
+			r.pos = tail.pos;
+			r.newlines += tail.newlines;
+			if (tail.last_newline) r.last_newline = tail.last_newline;
+			return r;
+		}
+		inline void collect_line_starts(char const* p, char const* end, std::uint32_t base, std::vector<std::uint32_t>& out) {
+			auto q = p;
+			for (; end - q >= 16; q += 16) {
+				auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+					_mm_loadu_si128(reinterpret_cast<__m128i const*>(q)), _mm_set1_epi8('\n'))));
+				for (; mask; mask &= mask - 1)
+					out.push_back(base + static_cast<std::uint32_t>(q - p + std::countr_zero(mask)) + 1);
+			}
+			scalar::collect_line_starts(q, end, base + static_cast<std::uint32_t>(q - p), out);
+		}
+		// skips ASCII 16 bytes at a time and decodes the rest
+		inline char const* find_invalid_utf8(char const* p, char const* end) noexcept {
+			while (end - p >= 16) {
+				auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p))));
+				if (mask == 0) {
+					p += 16;
+					continue;
+				}
+				p += std::countr_zero(mask);
+				auto n = unicode::decode(p, end).length;
+				if (n == 0) return p;
+				p += n;
+			}
+			return scalar::find_invalid_utf8(p, end);
+		}
+	} // namespace sse2
+
+	namespace avx2 {
+		FRONTEND_TARGET_AVX2 inline char const* find_string_special(char const* p, char const* end) noexcept {
+			for (; end - p >= 32; p += 32) {
+				auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+				auto hit = _mm256_or_si256(_mm256_or_si256(
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+				if (auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit)))
+					return p + std::countr_zero(mask);
+			}
+			return sse2::find_string_special(p, end);
+		}
+		FRONTEND_TARGET_AVX2 inline comment_end_t find_comment_end(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			for (; end - p > 32; p += 32) {
+				auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+				auto next = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + 1));
+				auto close = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+					_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')), _mm256_cmpeq_epi8(next, _mm256_set1_epi8('/')))));
+				auto newline = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+				if (close) {
+					auto pos = std::countr_zero(close);
+					newline &= pos == 0 ? 0u : (~0u >> (32 - pos));
+					r.pos = p + pos;
+					if (newline) {
+						r.newlines += std::popcount(newline);
+						r.last_newline = p + 31 - std::countl_zero(newline);
+					}
+					return r;
+				}
+				if (newline) {
+					r.newlines += std::popcount(newline);
+					r.last_newline = p + 31 - std::countl_zero(newline);
+				}
+			}
+			auto tail = sse2::find_comment_end(p, end);
+			r.pos = tail.pos;
+			r.newlines += tail.newlines;
+			if (tail.last_newline) r.last_newline = tail.last_newline;
+			return r;
+		}
+		FRONTEND_TARGET_AVX2 inline comment_end_t find_backquote(char const* p, char const* end) noexcept {
+			comment_end_t r{ end, 0, nullptr };
+			for (; end - p >= 32; p += 32) {
+				auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+				auto close = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('`'))));
+				auto newline = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+				if (close) {
+					auto pos = std::countr_zero(close);
+					newline &= pos == 0 ? 0u : (~0u >> (32 - pos));
+					r.pos = p + pos;
+					if (newline) {
+						r.newlines += std::popcount(newline);
+						r.last_newline = p + 31 - std::countl_zero(newline);
+					}
+					return r;
+				}
+				if (newline) {
+					r.newlines += std::popcount(newline);
+					r.last_newline = p + 31 - std::countl_zero(newline);
+				}
+			}
+			auto tail = sse2::find_backquote(p, end);
+			r.pos = tail.pos;
+			r.newlines += tail.newlines;
+			if (tail.last_newline) r.last_newline = tail.last_newline;
+			return r;
+		}
+		FRONTEND_TARGET_AVX2 inline void collect_line_starts(char const* p, char const* end, std::uint32_t base, std::vector<std::uint32_t>& out) {
+			auto q = p;
+			for (; end - q >= 32; q += 32) {
+				auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+					_mm256_loadu_si256(reinterpret_cast<__m256i const*>(q)), _mm256_set1_epi8('\n'))));
+				for (; mask; mask &= mask - 1)
+					out.push_back(base + static_cast<std::uint32_t>(q - p + std::countr_zero(mask)) + 1);
+			}
+			sse2::collect_line_starts(q, end, base + static_cast<std::uint32_t>(q - p), out);
+		}
+
+		// UTF-8 validation by the lookup algorithm of Keiser and Lemire: every byte is classified
+		// with the one before it by three nibble lookups, whose results share a bit only for a
+		// pair that is an error, then the bytes that must be a 3rd or 4th byte are checked
+		// against the lead 2 or 3 bytes back.
+		namespace utf8 {
+			inline constexpr std::uint8_t too_short = 1 << 0;
+			inline constexpr std::uint8_t too_long = 1 << 1;
+			inline constexpr std::uint8_t overlong_3 = 1 << 2;
+			inline constexpr std::uint8_t too_large = 1 << 3;
+			inline constexpr std::uint8_t surrogate = 1 << 4;
+			inline constexpr std::uint8_t overlong_2 = 1 << 5;
+			inline constexpr std::uint8_t too_large_1000 = 1 << 6;
+			inline constexpr std::uint8_t overlong_4 = 1 << 6;
+			inline constexpr std::uint8_t two_conts = 1 << 7;
+			inline constexpr std::uint8_t carry = too_short | too_long | two_conts;
+
+			// by the high nibble of the first byte
+			alignas(16) inline constexpr std::uint8_t byte_1_high[16] = {
+				too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+				two_conts, two_conts, two_conts, two_conts,
+				too_short | overlong_2,
+				too_short,
+				too_short | overlong_3 | surrogate,
+				too_short | too_large | too_large_1000 | overlong_4,
+			};
+			// by the low nibble of the first byte
+			alignas(16) inline constexpr std::uint8_t byte_1_low[16] = {
+				carry | overlong_3 | overlong_2 | overlong_4,
+				carry | overlong_2,
+				carry,
+				carry,
+				carry | too_large,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000 | surrogate,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+			};
+			// by the high nibble of the second byte
+			alignas(16) inline constexpr std::uint8_t byte_2_high[16] = {
+				too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_short, too_short, too_short, too_short,
+			};
+			// a lead in the last 3 bytes of a block whose sequence goes on in the next one
+			inline constexpr std::array<std::uint8_t, 32> incomplete_max = [] {
+				std::array<std::uint8_t, 32> max{};
+				for (auto& m : max) m = 0xff;
+				max[29] = 0xf0 - 1;
+				max[30] = 0xe0 - 1;
+				max[31] = 0xc0 - 1;
+				return max;
+			}();
+
+			FRONTEND_TARGET_AVX2 inline __m256i lookup(std::uint8_t const (&table)[16], __m256i nibbles) noexcept {
+				return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(table))), nibbles);
+			}
+			FRONTEND_TARGET_AVX2 inline __m256i block_errors(__m256i input, __m256i prev_input) noexcept {
+				// input shifted by 1, 2 and 3 bytes, with the last bytes of prev_input shifted in
+				auto const carried = _mm256_permute2x128_si256(prev_input, input, 0x21);
+				auto const prev1 = _mm256_alignr_epi8(input, carried, 15);
+				auto const prev2 = _mm256_alignr_epi8(input, carried, 14);
+				auto const prev3 = _mm256_alignr_epi8(input, carried, 13);
+				auto const low_nibble = _mm256_set1_epi8(0x0f);
+				auto const special = _mm256_and_si256(_mm256_and_si256(
+					lookup(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble)),
+					lookup(byte_1_low, _mm256_and_si256(prev1, low_nibble))),
+					lookup(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble)));
+				// the high bit is set after a 3 or 4 byte lead 2 bytes back, or a 4 byte one 3 bytes back
+				auto const must_be_continuation = _mm256_and_si256(_mm256_or_si256(
+					_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+					_mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80)))),
+					_mm256_set1_epi8(static_cast<char>(0x80)));
+				return _mm256_xor_si256(must_be_continuation, special);
+			}
+			// where to validate again from, byte by byte, once a block at p has an error:
+			// the start of the sequence that may run into it
+			inline char const* resync(char const* begin, char const* p) noexcept {
+				auto q = p - std::min<std::ptrdiff_t>(p - begin, 3);
+				while (q < p && (static_cast<unsigned char>(*q) & 0xc0) == 0x80) ++q;
+				return q;
+			}
+		} // namespace utf8
+		FRONTEND_TARGET_AVX2 inline char const* find_invalid_utf8(char const* p, char const* end) noexcept {
+			auto const begin = p;
+			auto const incomplete_max = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(utf8::incomplete_max.data()));
+			auto prev_input = _mm256_setzero_si256();
+			auto prev_incomplete = _mm256_setzero_si256();
+			for (; end - p >= 32; p += 32) {
+				auto input = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+				__m256i error;
+				if (_mm256_movemask_epi8(input) == 0) {
+					// ASCII, which is only wrong if the block before ended in a lead
+					error = prev_incomplete;
+					prev_incomplete = _mm256_setzero_si256();
+				}
+				else {
+					error = utf8::block_errors(input, prev_input);
+					prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+				}
+				// the error is located byte by byte, which is also what the tail needs
+				if (!_mm256_testz_si256(error, error)) break;
+				prev_input = input;
+			}
+			return sse2::find_invalid_utf8(utf8::resync(begin, p), end);
+		}
+	} // namespace avx2
+
+	inline bool cpu_has_avx2() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+		int regs[4];
+		__cpuid(regs, 0);
+		if (regs[0] < 7) return false;
+		__cpuid(regs, 1);
+		// the os has to save the ymm registers
+		if (!(regs[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(regs, 7, 0);
+		return regs[1] & (1 << 5);
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif // FRONTEND_SIMD_X86
+
+	struct kernels_t {
+		char const* (*find_string_special)(char const*, char const*) noexcept;
+		comment_end_t (*find_comment_end)(char const*, char const*) noexcept;
+		comment_end_t (*find_backquote)(char const*, char const*) noexcept;
+		void (*collect_line_starts)(char const*, char const*, std::uint32_t, std::vector<std::uint32_t>&);
+		char const* (*find_invalid_utf8)(char const*, char const*) noexcept;
+	};
+	inline kernels_t select_kernels() noexcept {
+#ifdef FRONTEND_SIMD_X86
+		if (cpu_has_avx2())
+			return { avx2::find_string_special, avx2::find_comment_end, avx2::find_backquote, avx2::collect_line_starts, avx2::find_invalid_utf8 };
+		return { sse2::find_string_special, sse2::find_comment_end, sse2::find_backquote, sse2::collect_line_starts, sse2::find_invalid_utf8 };
+#else
+		return { scalar::find_string_special, scalar::find_comment_end, scalar::find_backquote, scalar::collect_line_starts, scalar::find_invalid_utf8 };
+#endif
+	}
+	inline kernels_t const kernels = select_kernels();
+
+	// returns the first byte in [p, end) that is not ' ', '\t', '\r', '\f' or '\v'
+	inline char const* skip_inline_space(char const* p, char const* end) noexcept {
+#ifdef FRONTEND_SIMD_X86
+		return sse2::skip_inline_space(p, end);
+#else
+		while (p < end && is_inline_space(*p)) ++p;
+		return p;
+#endif
+	}
+	// returns the first byte in [p, end) that is not in [_a-zA-Z0-9]
+	inline char const* skip_identifier(char const* p, char const* end) noexcept {
+#ifdef FRONTEND_SIMD_X86
+		return sse2::skip_identifier(p, end);
+#else
+		while (p < end && is_identifier_char(*p)) ++p;
+		return p;
+#endif
+	}
+	// returns the first '"', '\\' or '\n' in [p, end)
+	inline char const* find_string_special(char const* p, char const* end) noexcept {
+		return kernels.find_string_special(p, end);
+	}
+	// finds the first "*/" starting in [p, end) and counts the newlines before it
+	inline comment_end_t find_comment_end(char const* p, char const* end) noexcept {
+		return kernels.find_comment_end(p, end);
+	}
+	// finds the first '`' in [p, end) and counts the newlines before it
+	inline comment_end_t find_backquote(char const* p, char const* end) noexcept {
+		return kernels.find_backquote(p, end);
+	}
+	// appends base + (offset of the byte after each '\n' in [p, end))
+	inline void collect_line_starts(char const* p, char const* end, std::uint32_t base, std::vector<std::uint32_t>& out) {
+		kernels.collect_line_starts(p, end, base, out);
+	}
+	// returns the first byte in [p, end) that does not start a well-formed UTF-8 sequence,
+	// or end if it is all valid
+	inline char const* find_invalid_utf8(char const* p, char const* end) noexcept {
+		return kernels.find_invalid_utf8(p, end);
+	}
+} // namespace frontend::simd
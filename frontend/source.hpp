@@ -0,0 +1,107 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// the offset of the first byte of every line, line 0 starts at offset 0
+	struct line_index_t {
+		std::vector<std::uint32_t> line_starts;
+
+		void build(std::string_view source) {
+			line_starts.clear();
+			line_starts.reserve(source.size() / 32 + 1);
+			line_starts.push_back(0);
+			simd::collect_line_starts(source.data(), source.data() + source.size(), 0, line_starts);
+		}
+		std::size_t line_cnt() const noexcept {
+			return line_starts.size();
+		}
+		location_t locate(std::uint32_t offset) const noexcept {
+			assert(!line_starts.empty());
+			auto itr = std::ranges::upper_bound(line_starts, offset) - 1;
+			return { static_cast<std::size_t>(itr - line_starts.begin()), offset - *itr };
+		}
+	};
+
+	// A source file known to the frontend, identified by its index in `sources`.
+	// The line index is only built when a location is first asked for.
+	struct source_t {
+		char const* filename;
+		std::string_view content;
+		source_t(char const* file_name, std::string_view c) : filename(file_name), content(c) {}
+		location_t locate(std::uint32_t offset) const {
+			std::call_once(lines_built, [this] { lines.build(content); });
+			return lines.locate(offset);
+		}
+	private:
+		mutable std::once_flag lines_built;
+		mutable line_index_t lines;
+	};
+	// a deque, so registering a file never moves the others
+	inline std::deque<source_t> sources;
+	inline std::uint16_t register_source(char const* filename, std::string_view content) {
+		if (sources.size() > std::numeric_limits<std::uint16_t>::max())
+			panic("too many source files, file ids are 16-bit\n");
+		sources.emplace_back(filename, content);
+		return static_cast<std::uint16_t>(sources.size() - 1);
+	}
+
+	// A token that only knows where it is: its line and column are looked up in
+	// the line index of its file when a diagnostic or to_string() needs them.
+	struct compact_token_t {
+		std::uint32_t offset;
+		std::uint32_t length;
+		std::uint16_t tokenkind;
+		std::uint16_t file_id;
+		// kind dependent payload: the symbol of an IDENT lexed with a symbol table, else
+		// no_symbol until a later stage fills it. symbol ids start at 0, so 0 is a symbol.
+		std::uint32_t value;
+
+		token_e kind() const noexcept {
+			return tokenkind == compact_illegal_kind ? token_e::ILLEGAL : token_e{ tokenkind };
+		}
+		source_t const& source() const noexcept {
+			return sources[file_id];
+		}
+		std::string_view text() const noexcept {
+			return source().content.substr(offset, length);
+		}
+		location_t location() const {
+			return source().locate(offset);
+		}
+		std::string to_string() const {
+			auto [line, column] = location();
+			return fast_io::concat(
+				"Kind:", identifiers.at(std::to_underlying(kind())),
+				" (In file ", fast_io::mnp::os_c_str(source().filename),
+				", Line:", line,
+				" Column:", column,
+				")");
+		}
+	};
+	static_assert(sizeof(compact_token_t) == 16);
+
+	// lexes a registered source into compact tokens, ending with L_EOF
+	inline std::vector<compact_token_t> tokenize_compact(std::uint16_t file_id, symbol_sink_t symbols = {})
+	{
+		auto const& src = sources[file_id];
+		if (src.content.size() > std::numeric_limits<std::uint32_t>::max())
+			panic("file \"", fast_io::mnp::os_c_str(src.filename), "\" is too large to be tokenized into 32-bit offsets\n");
+		check_utf8(src.content, src.filename);
+		std::vector<compact_token_t> tokens;
+		tokens.reserve(estimated_token_cnt(src.content.size()));
+		basic_scanner_t<buffer_policy> lex{ src.filename, src.content };
+		lex.symbols = symbols;
+		auto const base = src.content.data();
+		for (;;) {
+			auto token = lex.next_token();
+			tokens.push_back({
+				static_cast<std::uint32_t>(token.begin - base),
+				static_cast<std::uint32_t>(token.end - token.begin),
+				static_cast<std::uint16_t>(token.tokenkind == token_e::ILLEGAL ? compact_illegal_kind : std::to_underlying(token.tokenkind)),
+				file_id,
+				token.symbol });
+			if (token.tokenkind == token_e::L_EOF) break;
+		}
+		return tokens;
+	}
+} // namespace frontend
@@ -0,0 +1,243 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// A scanner over input that arrives in chunks, e.g. from a pipe.
+	//
+	// Only the unfinished tail of the input is buffered. A token that may go on in the
+	// next chunk is held back and lexed again from its start once the chunk arrives,
+	// which covers identifiers, numbers, operators and strings cut at a chunk boundary.
+	// Comments are the only tokens allowed to outgrow `max_token_size`: they are scanned
+	// to their end without being buffered and reported with their last piece as text.
+	// So the buffer never exceeds one chunk plus `max_token_size`, whatever the input size.
+	// Input is checked to be UTF-8 as it is fed, but for a sequence cut by the chunk end.
+	struct stream_scanner_t {
+		static constexpr std::size_t lookahead_margin = scanner_t::lookahead;
+
+		explicit stream_scanner_t(char const* file_name = "", std::size_t max_token = std::size_t{ 1 } << 16)
+			: filename(file_name), max_token_size(max_token) {}
+
+		// identifiers are interned here when set, once their token is known to be complete
+		symbol_sink_t symbols{};
+		// errors are recorded here and returned as ILLEGAL tokens when set, see scanner_t
+		std::vector<diagnostic_t>* diagnostics{};
+
+		// appends the next chunk. Tokens returned so far point into the buffer and are
+		// invalidated, so drain next_token() before feeding more.
+		void feed(std::string_view chunk)
+		{
+			// a sequence cut by the last chunk is kept until it is checked
+			auto const dropped = std::min(pos, validated);
+			window.erase(0, dropped);
+			window_offset += dropped;
+			drain_from -= std::min(drain_from, dropped);
+			pos -= dropped;
+			validated -= dropped;
+			window.append(chunk);
+			check_utf8();
+		}
+		// no more input will come
+		void finish() {
+			finished = true;
+			check_utf8();
+		}
+		std::size_t buffered() const noexcept {
+			return window.size() - pos;
+		}
+
+		// the next complete token, or nothing if more input is needed first.
+		// after finish() this always returns a token, L_EOF at the end.
+		std::optional<token_t> next_token()
+		{
+			if (draining != drain_e::NONE)
+				return drain_comment();
+			skip_blank_lines();
+			auto const begin = window.data();
+			auto const end = begin + window.size();
+			if (!finished && end - (begin + pos) > static_cast<std::ptrdiff_t>(max_token_size)) {
+				if (window.compare(pos, 2, "/*") == 0 || window.compare(pos, 2, "//") == 0)
+					return start_draining();
+			}
+
+			auto lex = make_scanner();
+			auto token = lex.next_token();
+			bool failed = token.tokenkind == token_e::ILLEGAL;
+			if (!finished) {
+				// the scanner ran out of input, or the token ends too close to the end
+				// to know that the next chunk does not continue it
+				bool may_continue = failed ? lex.ptr == end
+					: token.tokenkind == token_e::L_EOF || end - lex.ptr < static_cast<std::ptrdiff_t>(lookahead_margin)
+					|| (token.tokenkind == token_e::HASHTAG && std::all_of(lex.ptr, static_cast<char const*>(end), [](char c) { return c == '#'; }));
+				if (may_continue) {
+					if (end - (begin + pos) > static_cast<std::ptrdiff_t>(max_token_size)) {
+						perrln("token longer than ", max_token_size, " bytes in Line:", line_count, " in file ", fast_io::mnp::os_c_str(filename));
+						throw std::exception{};
+					}
+					return std::nullopt;
+				}
+			}
+			if (failed) {
+				// a real error
+				if (!diagnostics) {
+					// lex it again to report it, which prints the error and throws
+					auto loud = make_scanner();
+					loud.diagnostics = nullptr;
+					loud.next_token();
+					throw std::exception{};
+				}
+				auto d = scratch.back();
+				if (d.line == line_count) d.column += column_bias();
+				diagnostics->push_back(d);
+			}
+			if (token.line == line_count)
+				token.column += column_bias();
+			if (symbols && token.tokenkind == token_e::IDENT)
+				token.symbol = symbols({ token.begin, token.end });
+			if (lex.line_count != line_count) {
+				line_count = lex.line_count;
+				line_offset = window_offset + (lex.line_begin - begin);
+			}
+			pos = lex.ptr - begin;
+			return token;
+		}
+
+	private:
+		enum class drain_e : std::uint8_t {
+			NONE,
+			LINE_COMMENT,
+			BLOCK_COMMENT,
+		};
+
+		// reports the first invalid UTF-8 sequence, like tokenize_all
+		void check_utf8()
+		{
+			if (utf8_failed) return;
+			auto const begin = window.data();
+			auto const end = begin + window.size();
+			auto const stop = finished ? end : unicode::complete_prefix_end(begin + validated, end);
+			auto const bad = simd::find_invalid_utf8(begin + validated, stop);
+			validated = static_cast<std::size_t>(stop - begin);
+			if (bad == stop) return;
+			utf8_failed = true;
+			// the current line starts before pos, and the bad byte is on it or after it
+			auto line = line_count;
+			auto line_start = line_offset;
+			for (auto p = begin + pos; p < bad; ++p) {
+				if (*p == '\n') {
+					++line;
+					line_start = window_offset + (p + 1 - begin);
+				}
+			}
+			report_invalid_utf8(filename, line, static_cast<std::size_t>(window_offset + (bad - begin) - line_start), diagnostics);
+		}
+		// bytes of the current line that were already dropped from the buffer
+		std::size_t column_bias() const noexcept {
+			return line_offset < window_offset ? static_cast<std::size_t>(window_offset - line_offset) : 0;
+		}
+		scanner_t make_scanner()
+		{
+			auto const begin = window.data();
+			scanner_t lex{ filename, { begin + pos, begin + window.size() } };
+			// the token may only have been cut short, so errors are not final yet
+			scratch.clear();
+			lex.diagnostics = &scratch;
+			lex.line_count = line_count;
+			lex.line_begin = begin + (line_offset < window_offset ? 0 : line_offset - window_offset);
+			return lex;
+		}
+		// so that a held back token is measured from its own first byte
+		void skip_blank_lines() noexcept
+		{
+			auto const begin = window.data();
+			auto const end = begin + window.size();
+			for (char const* p = begin + pos; ; ++p) {
+				p = simd::skip_inline_space(p, end);
+				if (p == end || *p != '\n') {
+					pos = p - begin;
+					return;
+				}
+				++line_count;
+				line_offset = window_offset + (p + 1 - begin);
+			}
+		}
+		std::optional<token_t> start_draining()
+		{
+			draining = window[pos + 1] == '*' ? drain_e::BLOCK_COMMENT : drain_e::LINE_COMMENT;
+			drain_line = line_count;
+			drain_column = static_cast<std::size_t>(window_offset + pos - line_offset);
+			drain_from = pos + 2;
+			return drain_comment();
+		}
+		std::optional<token_t> drain_comment()
+		{
+			auto const begin = window.data();
+			auto const end = begin + window.size();
+			auto const from = begin + std::min(drain_from, window.size());
+			char const* comment_end;
+			if (draining == drain_e::BLOCK_COMMENT) {
+				auto r = simd::find_comment_end(from, end);
+				if (r.last_newline) {
+					line_count += r.newlines;
+					line_offset = window_offset + (r.last_newline + 1 - begin);
+				}
+				if (r.pos == end) {
+					if (finished) return unexpected_eof();
+					// keep a trailing '*', the '/' may come with the next chunk
+					pos = window.size() - (window.size() != 0 && window.back() == '*');
+					drain_from = pos;
+					return std::nullopt;
+				}
+				comment_end = r.pos + 2;
+			}
+			else {
+				// up to the newline, or the end of input
+				auto newline = static_cast<char const*>(std::memchr(from, '\n', end - from));
+				if (!newline && !finished) {
+					pos = drain_from = window.size();
+					return std::nullopt;
+				}
+				comment_end = newline ? newline : end;
+			}
+			// the comment started in a chunk that is gone, only its tail is left
+			token_t token{ filename, token_e::COMMENT, begin + std::min(pos, drain_from), comment_end, drain_line, drain_column };
+			pos = comment_end - begin;
+			draining = drain_e::NONE;
+			return token;
+		}
+		// the block comment being drained runs to the end of input
+		token_t unexpected_eof()
+		{
+			if (!diagnostics) {
+				perrln("unexpected eof in file: ", fast_io::mnp::os_c_str(filename));
+				throw std::exception{};
+			}
+			diagnostics->push_back({ filename, "unexpected eof", drain_line, drain_column });
+			auto const begin = window.data();
+			token_t token{ filename, token_e::ILLEGAL, begin + std::min(pos, drain_from), begin + window.size(), drain_line, drain_column };
+			pos = window.size();
+			draining = drain_e::NONE;
+			return token;
+		}
+
+		char const* filename;
+		std::size_t max_token_size;
+		std::string window;
+		// diagnostics of the token being tried
+		std::vector<diagnostic_t> scratch;
+		// window[0, pos) is consumed
+		std::size_t pos{};
+		// window[0, validated) is checked to be UTF-8
+		std::size_t validated{};
+		bool utf8_failed{};
+		// the offset of window[0] in the whole input
+		std::uint64_t window_offset{};
+		std::size_t line_count{};
+		// the offset of the first byte of the current line in the whole input
+		std::uint64_t line_offset{};
+		drain_e draining{ drain_e::NONE };
+		std::size_t drain_from{};
+		std::size_t drain_line{};
+		std::size_t drain_column{};
+		bool finished{};
+	};
+} // namespace frontend
@@ -0,0 +1,34 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// The value of a STRING or RAW_STRING token, given its text as lexed, without quotes.
+	// Raw strings and strings without a '\' are returned as they are, a view of the source.
+	// The others are unescaped into `arena`: the runs between escapes are copied whole,
+	// so a large literal costs a memchr and a memcpy per escape, not a loop per byte.
+	inline std::string_view decode_string(token_e kind, std::string_view text, string_arena_t& arena)
+	{
+		if (kind == token_e::RAW_STRING) return text;
+		assert(kind == token_e::STRING);
+		auto p = text.data();
+		auto const end = p + text.size();
+		auto escape = static_cast<char const*>(std::memchr(p, '\\', text.size()));
+		if (!escape) return text;
+		// unescaping never makes a string longer
+		auto const begin = arena.allocate(text.size());
+		auto out = begin;
+		do {
+			std::memcpy(out, p, escape - p);
+			out += escape - p;
+			p = escape + 1;
+			if (p == end) break;
+			if (*p == '\n') ++p;
+			else if (*p == '\r' && p + 1 != end && p[1] == '\n') p += 2;
+			else *out++ = static_cast<char>(details::decode_escape(p, end));
+		} while ((escape = static_cast<char const*>(std::memchr(p, '\\', end - p))));
+		std::memcpy(out, p, end - p);
+		out += end - p;
+		arena.shrink_last(out);
+		return { begin, static_cast<std::size_t>(out - begin) };
+	}
+} // namespace frontend
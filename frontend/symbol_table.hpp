@@ -0,0 +1,218 @@
+#pragma once
+#include "../utils.hpp"
+
+// Interning of identifiers into dense 32-bit symbol ids, so that later stages compare
+// names as integers. Both tables keep every name in an arena that never moves, and
+// a name() is valid as long as its table.
+namespace frontend {
+	inline constexpr std::uint32_t no_symbol = static_cast<std::uint32_t>(-1);
+
+	namespace details {
+		inline std::uint64_t symbol_hash(std::string_view s) noexcept
+		{
+			constexpr std::uint64_t k = 0x9e37'79b9'7f4a'7c15;
+			std::uint64_t h = s.size() * k;
+			auto p = s.data();
+			auto n = s.size();
+			for (; n >= 8; p += 8, n -= 8) {
+				std::uint64_t w;
+				std::memcpy(&w, p, 8);
+				h = std::rotl((h ^ w) * k, 29);
+			}
+			if (n) {
+				std::uint64_t w{};
+				std::memcpy(&w, p, n);
+				h = std::rotl((h ^ w) * k, 29);
+			}
+			h ^= h >> 32;
+			h *= k;
+			return h ^ h >> 29;
+		}
+
+		// open addressing with linear probing, at most half full. slots keep the low
+		// 32 bits of the hash, which are also where probing starts, so growing needs
+		// no names; names are only compared through `name_of(id)`.
+		struct symbol_map_t {
+			struct slot_t {
+				std::uint32_t hash;
+				std::uint32_t id;
+			};
+			std::vector<slot_t> slots;
+			std::size_t cnt{};
+
+			template <typename NameOf>
+			std::uint32_t find(std::uint32_t hash, std::string_view s, NameOf&& name_of) const noexcept
+			{
+				if (slots.empty()) return no_symbol;
+				auto const mask = slots.size() - 1;
+				for (auto i = hash & mask; ; i = (i + 1) & mask) {
+					auto const& slot = slots[i];
+					if (slot.id == no_symbol) return no_symbol;
+					if (slot.hash == hash && name_of(slot.id) == s) return slot.id;
+				}
+			}
+			// `id` must not be in the map yet
+			void insert(std::uint32_t hash, std::uint32_t id)
+			{
+				if ((cnt + 1) * 2 > slots.size()) grow();
+				place({ hash, id });
+				++cnt;
+			}
+		private:
+			void place(slot_t slot) noexcept
+			{
+				auto const mask = slots.size() - 1;
+				auto i = slot.hash & mask;
+				while (slots[i].id != no_symbol) i = (i + 1) & mask;
+				slots[i] = slot;
+			}
+			void grow()
+			{
+				std::vector<slot_t> old(std::max<std::size_t>(64, slots.size() * 2), slot_t{ 0, no_symbol });
+				old.swap(slots);
+				for (auto const& slot : old)
+					if (slot.id != no_symbol) place(slot);
+			}
+		};
+
+		// names by id in segments of doubling size that are never moved, so that
+		// readers need no lock while other threads append
+		struct segmented_names_t {
+			static constexpr std::size_t first_segment = 1024;
+			static constexpr std::size_t segment_cnt = 22;
+
+			segmented_names_t() = default;
+			segmented_names_t(segmented_names_t const&) = delete;
+			segmented_names_t& operator=(segmented_names_t const&) = delete;
+			~segmented_names_t()
+			{
+				for (auto& segment : segments) delete[] segment.load(std::memory_order_relaxed);
+			}
+			std::string_view get(std::uint32_t id) const noexcept
+			{
+				auto [k, i] = locate(id);
+				return segments[k].load(std::memory_order_acquire)[i];
+			}
+			void set(std::uint32_t id, std::string_view name)
+			{
+				auto [k, i] = locate(id);
+				auto segment = segments[k].load(std::memory_order_acquire);
+				if (!segment) {
+					auto fresh = new std::string_view[first_segment << k];
+					if (segments[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel)) segment = fresh;
+					else delete[] fresh;
+				}
+				segment[i] = name;
+			}
+		private:
+			// segment k holds ids [first_segment * (2^k - 1), first_segment * (2^(k+1) - 1))
+			static std::pair<std::size_t, std::size_t> locate(std::uint32_t id) noexcept
+			{
+				auto k = static_cast<std::size_t>(std::bit_width(id / first_segment + 1) - 1);
+				return { k, id - first_segment * ((std::size_t{ 1 } << k) - 1) };
+			}
+			std::array<std::atomic<std::string_view*>, segment_cnt> segments{};
+		};
+	} // namespace details
+
+	// a symbol table for one thread
+	struct symbol_table_t {
+		std::uint32_t intern(std::string_view s)
+		{
+			auto hash = static_cast<std::uint32_t>(details::symbol_hash(s));
+			if (auto id = map.find(hash, s, [this](std::uint32_t i) { return names[i]; }); id != no_symbol)
+				return id;
+			if (names.size() == no_symbol)
+				panic("more than ", no_symbol, " distinct identifiers\n");
+			auto id = static_cast<std::uint32_t>(names.size());
+			names.push_back(arena.store(s));
+			map.insert(hash, id);
+			return id;
+		}
+		// no_symbol if `s` was never interned
+		std::uint32_t find(std::string_view s) const noexcept {
+			return map.find(static_cast<std::uint32_t>(details::symbol_hash(s)), s, [this](std::uint32_t i) { return names[i]; });
+		}
+		std::string_view name(std::uint32_t id) const noexcept {
+			assert(id < names.size());
+			return names[id];
+		}
+		std::size_t size() const noexcept {
+			return names.size();
+		}
+	private:
+		details::symbol_map_t map;
+		std::vector<std::string_view> names;
+		string_arena_t arena;
+	};
+
+	// A symbol table shared by lexing threads. Names are split over shards by hash,
+	// each behind its own mutex, and ids come from one counter so they stay dense.
+	// The order of ids depends on thread timing, the ids of a name never change.
+	struct concurrent_symbol_table_t {
+		static constexpr std::size_t shard_cnt = 64;
+
+		std::uint32_t intern(std::string_view s)
+		{
+			auto hash = details::symbol_hash(s);
+			auto& shard = shards[hash >> 58];
+			auto h32 = static_cast<std::uint32_t>(hash);
+			auto name_of = [this](std::uint32_t i) { return names.get(i); };
+			std::lock_guard lock{ shard.mutex };
+			if (auto id = shard.map.find(h32, s, name_of); id != no_symbol)
+				return id;
+			auto id = next_id.fetch_add(1, std::memory_order_relaxed);
+			if (id == no_symbol)
+				panic("more than ", no_symbol, " distinct identifiers\n");
+			names.set(id, shard.arena.store(s));
+			shard.map.insert(h32, id);
+			return id;
+		}
+		std::uint32_t find(std::string_view s)
+		{
+			auto hash = details::symbol_hash(s);
+			auto& shard = shards[hash >> 58];
+			std::lock_guard lock{ shard.mutex };
+			return shard.map.find(static_cast<std::uint32_t>(hash), s, [this](std::uint32_t i) { return names.get(i); });
+		}
+		// `id` must have been returned to this thread, or to one it synchronized with
+		std::string_view name(std::uint32_t id) const noexcept {
+			assert(id < size());
+			return names.get(id);
+		}
+		std::size_t size() const noexcept {
+			return next_id.load(std::memory_order_relaxed);
+		}
+	private:
+		static_assert(shard_cnt == 64, "shards are picked by the top 6 bits of the hash");
+		struct alignas(64) shard_t {
+			std::mutex mutex;
+			details::symbol_map_t map;
+			string_arena_t arena;
+		};
+		std::array<shard_t, shard_cnt> shards;
+		std::atomic<std::uint32_t> next_id{};
+		details::segmented_names_t names;
+	};
+
+	// Where a scanner sends identifiers, type erased so one scanner serves both tables.
+	struct symbol_sink_t {
+		std::uint32_t (*intern)(void*, std::string_view){};
+		void* table{};
+		// safe to call from several threads at once
+		bool concurrent{};
+
+		explicit operator bool() const noexcept {
+			return intern != nullptr;
+		}
+		std::uint32_t operator()(std::string_view s) const {
+			return intern(table, s);
+		}
+		static symbol_sink_t of(symbol_table_t& t) noexcept {
+			return { [](void* p, std::string_view s) { return static_cast<symbol_table_t*>(p)->intern(s); }, &t, false };
+		}
+		static symbol_sink_t of(concurrent_symbol_table_t& t) noexcept {
+			return { [](void* p, std::string_view s) { return static_cast<concurrent_symbol_table_t*>(p)->intern(s); }, &t, true };
+		}
+	};
+} // namespace frontend
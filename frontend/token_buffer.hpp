@@ -0,0 +1,141 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// token kinds are stored in 8 bits, ILLEGAL becomes 0xff
+	static_assert(std::to_underlying(token_e::operator_end) < 0xff, "token kinds no longer fit in std::uint8_t");
+	inline constexpr std::uint8_t compact_illegal_kind = 0xff;
+
+	inline constexpr bool is_number_kind(token_e kind) noexcept {
+		return token_e::INT_CHAR <= kind && kind <= token_e::FLOAT_HEX;
+	}
+
+	// All tokens of one source as a structure of arrays.
+	// The i-th token is [offsets[i], offsets[i] + lengths[i]) of the source it was lexed from,
+	// and the buffer always ends with an L_EOF token at the end of the source.
+	// Number and char literals also have their value in `numbers`.
+	struct token_buffer_t {
+		std::vector<std::uint8_t> kinds;
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> lengths;
+		number_table_t numbers;
+		// the symbol of every token, no_symbol but for IDENT.
+		// empty unless the source was lexed with a symbol table.
+		std::vector<std::uint32_t> symbols;
+
+		std::size_t size() const noexcept {
+			return kinds.size();
+		}
+		void reserve(std::size_t n) {
+			kinds.reserve(n);
+			offsets.reserve(n);
+			lengths.reserve(n);
+		}
+		void clear() noexcept {
+			kinds.clear();
+			offsets.clear();
+			lengths.clear();
+			numbers.clear();
+			symbols.clear();
+		}
+		void push_back(token_e kind, std::uint32_t offset, std::uint32_t length) {
+			kinds.push_back(kind == token_e::ILLEGAL ? compact_illegal_kind : static_cast<std::uint8_t>(kind));
+			offsets.push_back(offset);
+			lengths.push_back(length);
+		}
+		// decodes number literals right away, while their bytes are still in cache
+		template <typename Token>
+		void push_back(Token const& token, char const* base) {
+			if (is_number_kind(token.tokenkind))
+				numbers.push_back(static_cast<std::uint32_t>(size()), decode_number(token.tokenkind, { token.begin, token.end }));
+			push_back(token.tokenkind,
+				static_cast<std::uint32_t>(token.begin - base),
+				static_cast<std::uint32_t>(token.end - token.begin));
+		}
+		std::uint32_t symbol(std::size_t i) const noexcept {
+			assert(i < size());
+			return symbols.empty() ? no_symbol : symbols[i];
+		}
+		// the decoded value of the i-th token, nullptr if it is not a number
+		number_value_t const* number(std::size_t i) const noexcept {
+			return numbers.find(static_cast<std::uint32_t>(i));
+		}
+		token_e kind(std::size_t i) const noexcept {
+			assert(i < size());
+			return kinds[i] == compact_illegal_kind ? token_e::ILLEGAL : token_e{ kinds[i] };
+		}
+		std::string_view text(std::string_view source, std::size_t i) const noexcept {
+			assert(i < size());
+			return source.substr(offsets[i], lengths[i]);
+		}
+	};
+
+	// source code averages a few bytes per token, so this rarely reallocates
+	inline constexpr std::size_t estimated_token_cnt(std::size_t source_size) noexcept {
+		return source_size / 4 + 16;
+	}
+
+	// reports an invalid UTF-8 sequence like a lexing error: recorded in `diagnostics` if given, else thrown
+	inline void report_invalid_utf8(char const* filename, std::size_t line, std::size_t column, std::vector<diagnostic_t>* diagnostics)
+	{
+		if (!diagnostics) {
+			perrln("Invalid UTF-8 sequence. In Line:", line, ", Column:", column, " in file ", fast_io::mnp::os_c_str(filename));
+			throw std::exception{};
+		}
+		diagnostics->push_back({ filename, "Invalid UTF-8 sequence.", line, column });
+	}
+	// validates [begin, end) of the file starting at file_begin and reports its first invalid
+	// sequence, if any. begin and end must not cut a sequence, e.g. be at line starts.
+	inline void check_utf8(char const* file_begin, char const* begin, char const* end, char const* filename,
+		std::vector<diagnostic_t>* diagnostics = nullptr)
+	{
+		auto bad = simd::find_invalid_utf8(begin, end);
+		if (bad == end) return;
+		auto const line = static_cast<std::size_t>(std::count(file_begin, bad, '\n'));
+		auto line_begin = bad;
+		while (line_begin != file_begin && line_begin[-1] != '\n') --line_begin;
+		report_invalid_utf8(filename, line, static_cast<std::size_t>(bad - line_begin), diagnostics);
+	}
+	inline void check_utf8(std::string_view source, char const* filename, std::vector<diagnostic_t>* diagnostics = nullptr)
+	{
+		check_utf8(source.data(), source.data(), source.data() + source.size(), filename, diagnostics);
+	}
+
+	// lexes all of `source` in one pass, interning identifiers into `symbols` if given.
+	// with `diagnostics`, errors are recorded there and lexed as ILLEGAL tokens instead of thrown.
+	// the source is checked to be UTF-8 first, an invalid sequence is an error too.
+	// with `trivia`, comments go there with the whitespace and the buffer only has significant tokens.
+	inline void tokenize_all(token_buffer_t& buffer, std::string_view source, char const* filename = "", symbol_sink_t symbols = {},
+		std::vector<diagnostic_t>* diagnostics = nullptr, trivia_t* trivia = nullptr)
+	{
+		if (source.size() > std::numeric_limits<std::uint32_t>::max())
+			panic("file \"", fast_io::mnp::os_c_str(filename), "\" is too large to be tokenized into 32-bit offsets\n");
+		check_utf8(source, filename, diagnostics);
+		buffer.clear();
+		buffer.reserve(estimated_token_cnt(source.size()));
+		// only offsets are kept, so lines are not counted unless there is an error
+		basic_scanner_t<buffer_policy> lex{ filename, source };
+		lex.symbols = symbols;
+		lex.diagnostics = diagnostics;
+		if (symbols) buffer.symbols.reserve(estimated_token_cnt(source.size()));
+		if (trivia) {
+			trivia->clear();
+			trivia->first.reserve(estimated_token_cnt(source.size()) + 1);
+		}
+		auto const base = source.data();
+		for (;;) {
+			auto token = trivia ? next_significant_token(lex, *trivia, base) : lex.next_token();
+			buffer.push_back(token, base);
+			if (symbols) buffer.symbols.push_back(token.symbol);
+			if (token.tokenkind == token_e::L_EOF) break;
+		}
+		if (trivia) trivia->first.push_back(static_cast<std::uint32_t>(trivia->size()));
+	}
+	inline token_buffer_t tokenize_all(std::string_view source, char const* filename = "", symbol_sink_t symbols = {},
+		std::vector<diagnostic_t>* diagnostics = nullptr, trivia_t* trivia = nullptr)
+	{
+		token_buffer_t buffer;
+		tokenize_all(buffer, source, filename, symbols, diagnostics, trivia);
+		return buffer;
+	}
+} // namespace frontend
@@ -0,0 +1,44 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	// Multi-token lookahead over a scanner. Tokens are lexed once, into a ring buffer
+	// whose size is the lookahead depth rounded up to a power of two.
+	struct token_stream_t {
+		explicit token_stream_t(scanner_t s, std::size_t lookahead = 2)
+			: scanner(s)
+			, ring(std::bit_ceil(std::max<std::size_t>(lookahead, 1)))
+			, mask(ring.size() - 1)
+		{}
+
+		std::size_t depth() const noexcept {
+			return ring.size();
+		}
+		// the k-th token after the current one, peek(0) is the current token.
+		// past the end of the source every token is L_EOF.
+		token_t const& peek(std::size_t k = 0)
+		{
+			assert(k < depth());
+			while (buffered <= k) {
+				ring[(head + buffered) & mask] = scanner.next_token();
+				++buffered;
+			}
+			return ring[(head + k) & mask];
+		}
+		// returns the current token and moves to the next one
+		token_t advance()
+		{
+			auto token = peek();
+			head = (head + 1) & mask;
+			--buffered;
+			return token;
+		}
+
+	private:
+		scanner_t scanner;
+		std::vector<token_t> ring;
+		std::size_t mask;
+		std::size_t head{};
+		std::size_t buffered{};
+	};
+} // namespace frontend
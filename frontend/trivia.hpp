@@ -0,0 +1,76 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace frontend {
+	enum class trivia_e : std::uint8_t {
+		// a run of spaces, newlines and '\' line continuations
+		WHITESPACE,
+		COMMENT,
+	};
+
+	// The comments and whitespace of a source, kept out of its token stream and indexed by the
+	// token that follows them: the pieces before token i are [first[i], first[i + 1]), and
+	// those at the end of the source come before L_EOF. Nothing is lexed twice to get them,
+	// a whitespace piece is the gap the scanner skipped between two lexemes.
+	struct trivia_t {
+		std::vector<std::uint8_t> kinds;
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> lengths;
+		// one per token, and one more for the end of the last token's pieces
+		std::vector<std::uint32_t> first;
+
+		// the number of pieces
+		std::size_t size() const noexcept {
+			return kinds.size();
+		}
+		void clear() noexcept {
+			kinds.clear();
+			offsets.clear();
+			lengths.clear();
+			first.clear();
+		}
+		void push_back(trivia_e kind, std::uint32_t offset, std::uint32_t length) {
+			kinds.push_back(std::to_underlying(kind));
+			offsets.push_back(offset);
+			lengths.push_back(length);
+		}
+		// drops the pieces from n on
+		void resize(std::size_t n) {
+			kinds.resize(n);
+			offsets.resize(n);
+			lengths.resize(n);
+		}
+		trivia_e kind(std::size_t i) const noexcept {
+			assert(i < size());
+			return trivia_e{ kinds[i] };
+		}
+		std::string_view text(std::string_view source, std::size_t i) const noexcept {
+			assert(i < size());
+			return source.substr(offsets[i], lengths[i]);
+		}
+		// the indices of the pieces before the given token
+		auto before(std::size_t token) const noexcept {
+			assert(token + 1 < first.size());
+			return std::views::iota(std::size_t{ first[token] }, std::size_t{ first[token + 1] });
+		}
+	};
+
+	// lexes the next token that is not a comment, appending the comments and whitespace before
+	// it to `trivia` as that token's. The caller closes the table after L_EOF with
+	// trivia.first.push_back(trivia.size()).
+	template <typename Policy>
+	inline typename Policy::token_type next_significant_token(basic_scanner_t<Policy>& lex, trivia_t& trivia, char const* base)
+	{
+		static_assert(Policy::emit_comments, "the comments are trivia");
+		trivia.first.push_back(static_cast<std::uint32_t>(trivia.size()));
+		for (;;) {
+			auto const gap = lex.ptr;
+			auto token = lex.next_token();
+			if (lex.token_start != gap)
+				trivia.push_back(trivia_e::WHITESPACE, static_cast<std::uint32_t>(gap - base), static_cast<std::uint32_t>(lex.token_start - gap));
+			if (token.tokenkind != token_e::COMMENT)
+				return token;
+			trivia.push_back(trivia_e::COMMENT, static_cast<std::uint32_t>(token.begin - base), static_cast<std::uint32_t>(token.end - token.begin));
+		}
+	}
+} // namespace frontend
@@ -0,0 +1,94 @@
+#pragma once
+#include "../utils.hpp"
+#include "unicode_tables.hpp"
+
+// UTF-8 identifiers.
+// Identifiers are UAX #31 ones: an XID_Start or '_' followed by XID_Continue. ASCII runs
+// are skipped by the identifier kernel, only non-ASCII letters are decoded, one at a time,
+// and the CJK ideographs that make up most of them are told by their first two bytes.
+namespace frontend::unicode {
+	struct code_point_t {
+		char32_t value;
+		// 0 if [p, end) does not start with a well-formed sequence
+		std::uint8_t length;
+	};
+	// decodes the sequence at p, which starts with a byte >= 0x80
+	inline code_point_t decode(char const* p, char const* end) noexcept {
+		auto const c = static_cast<unsigned char>(*p);
+		// the second byte is narrowed for the leads of overlong forms, surrogates and > U+10FFFF
+		unsigned char lo = 0x80, hi = 0xbf;
+		std::uint8_t n;
+		char32_t value;
+		if (0xc2 <= c && c <= 0xdf) {
+			n = 2;
+			value = c & 0x1f;
+		}
+		else if (0xe0 <= c && c <= 0xef) {
+			n = 3;
+			value = c & 0x0f;
+			if (c == 0xe0) lo = 0xa0;
+			else if (c == 0xed) hi = 0x9f;
+		}
+		else if (0xf0 <= c && c <= 0xf4) {
+			n = 4;
+			value = c & 0x07;
+			if (c == 0xf0) lo = 0x90;
+			else if (c == 0xf4) hi = 0x8f;
+		}
+		else return { 0, 0 };
+		if (end - p < n) return { 0, 0 };
+		auto const c1 = static_cast<unsigned char>(p[1]);
+		if (c1 < lo || c1 > hi) return { 0, 0 };
+		value = value << 6 | (c1 & 0x3f);
+		for (std::uint8_t i{ 2 }; i < n; ++i) {
+			auto const ci = static_cast<unsigned char>(p[i]);
+			if ((ci & 0xc0) != 0x80) return { 0, 0 };
+			value = value << 6 | (ci & 0x3f);
+		}
+		return { value, n };
+	}
+
+	inline bool in_ranges(std::span<code_point_range_t const> ranges, char32_t c) noexcept {
+		auto itr = std::ranges::lower_bound(ranges, c, {}, &code_point_range_t::last);
+		return itr != ranges.end() && itr->first <= c;
+	}
+	inline bool is_xid_start(char32_t c) noexcept {
+		return in_ranges(xid_start_ranges, c);
+	}
+	inline bool is_xid_continue(char32_t c) noexcept {
+		return in_ranges(xid_continue_ranges, c);
+	}
+
+	// U+4E00..U+9FFF, all of them XID_Start
+	inline bool is_cjk_ideograph(char const* p, char const* end) noexcept {
+		auto const c = static_cast<unsigned char>(*p);
+		if (c < 0xe4 || c > 0xe9 || end - p < 3) return false;
+		auto const c1 = static_cast<unsigned char>(p[1]);
+		auto const c2 = static_cast<unsigned char>(p[2]);
+		return (c1 & 0xc0) == 0x80 && (c2 & 0xc0) == 0x80 && (c != 0xe4 || c1 >= 0xb8);
+	}
+	// the length of the non-ASCII letter at p if it may start an identifier, else 0
+	inline std::size_t identifier_start_length(char const* p, char const* end) noexcept {
+		if (is_cjk_ideograph(p, end)) return 3;
+		auto cp = decode(p, end);
+		return cp.length != 0 && is_xid_start(cp.value) ? cp.length : 0;
+	}
+	// the length of the non-ASCII letter at p if it may go on an identifier, else 0
+	inline std::size_t identifier_continue_length(char const* p, char const* end) noexcept {
+		if (is_cjk_ideograph(p, end)) return 3;
+		auto cp = decode(p, end);
+		return cp.length != 0 && is_xid_continue(cp.value) ? cp.length : 0;
+	}
+
+	// the end of the longest prefix of [begin, end) that does not stop inside a sequence,
+	// so that input arriving in pieces can be validated as it comes
+	inline char const* complete_prefix_end(char const* begin, char const* end) noexcept {
+		for (auto p = end; p != begin && end - p < 4; ) {
+			auto const c = static_cast<unsigned char>(*--p);
+			if ((c & 0xc0) == 0x80) continue;
+			auto const n = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 1;
+			return end - p < n ? p : end;
+		}
+		return end;
+	}
+} // namespace frontend::unicode
@@ -0,0 +1,122 @@
+#pragma once
+#include "../utils.hpp"
+
+namespace parallel {
+	// A fixed set of worker threads running index-parallel jobs.
+	// The calling thread takes part in every job, so a pool of size 1 runs inline.
+	struct thread_pool_t {
+		explicit thread_pool_t(std::size_t thread_cnt = std::max(1u, std::thread::hardware_concurrency()))
+		{
+			workers.reserve(thread_cnt - 1);
+			for (std::size_t i{ 1 }; i < thread_cnt; ++i)
+				workers.emplace_back([this] { work(); });
+		}
+		thread_pool_t(thread_pool_t const&) = delete;
+		thread_pool_t& operator=(thread_pool_t const&) = delete;
+		~thread_pool_t()
+		{
+			{
+				std::lock_guard lock{ mutex };
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto& w : workers) w.join();
+		}
+		std::size_t size() const noexcept {
+			return workers.size() + 1;
+		}
+
+		// runs f(i) for every i in [0, n) and returns when all of them are done.
+		// the first exception thrown by a task is rethrown here after the others finish.
+		template <typename F>
+		void for_each_index(std::size_t n, F&& f)
+		{
+			if (n == 0) return;
+			if (workers.empty() || n == 1) {
+				for (std::size_t i{}; i < n; ++i) f(i);
+				return;
+			}
+			std::lock_guard serialize{ job_mutex };
+			job_t job{ [](void* ctx, std::size_t i) { (*static_cast<std::remove_reference_t<F>*>(ctx))(i); }, &f, n };
+			{
+				std::lock_guard lock{ mutex };
+				current = &job;
+				++generation;
+			}
+			wake.notify_all();
+			run(job);
+			{
+				std::unique_lock lock{ mutex };
+				done.wait(lock, [&] { return job.finished == n && job.attached == 0; });
+				current = nullptr;
+			}
+			if (job.error) std::rethrow_exception(job.error);
+		}
+
+	private:
+		struct job_t {
+			job_t(void (*invoke_)(void*, std::size_t), void* ctx_, std::size_t n_) noexcept
+				: invoke(invoke_), ctx(ctx_), n(n_)
+			{ }
+			void (*invoke)(void*, std::size_t);
+			void* ctx;
+			std::size_t n;
+			std::atomic<std::size_t> next{};
+			// guarded by the pool mutex
+			std::size_t finished{};
+			std::size_t attached{};
+			std::exception_ptr error;
+		};
+		void run(job_t& job)
+		{
+			std::size_t cnt{};
+			std::exception_ptr error;
+			for (std::size_t i; (i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.n; ++cnt) {
+				try {
+					job.invoke(job.ctx, i);
+				}
+				catch (...) {
+					if (!error) error = std::current_exception();
+				}
+			}
+			std::lock_guard lock{ mutex };
+			job.finished += cnt;
+			if (error && !job.error) job.error = error;
+		}
+		void work()
+		{
+			std::size_t seen{};
+			for (;;) {
+				job_t* job;
+				{
+					std::unique_lock lock{ mutex };
+					wake.wait(lock, [&] { return stopping || (current && generation != seen); });
+					if (stopping) return;
+					seen = generation;
+					job = current;
+					++job->attached;
+				}
+				run(*job);
+				{
+					std::lock_guard lock{ mutex };
+					--job->attached;
+				}
+				done.notify_all();
+			}
+		}
+
+		std::vector<std::thread> workers;
+		std::mutex job_mutex;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		job_t* current{};
+		std::size_t generation{};
+		bool stopping{};
+	};
+
+	inline thread_pool_t& default_pool() {
+		static thread_pool_t pool;
+		return pool;
+	}
+} // namespace parallel
@@ -7,19 +7,33 @@
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <cmath>
 #include <cassert>
 
+#include <bit>
 #include <utility>
 #include <string>
 #include <string_view>
+#include <charconv>
 #include <array>
+#include <bitset>
+#include <span>
+#include <ranges>
+#include <limits>
 #include <vector>
 #include <list>
+#include <deque>
 #include <set>
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
 #include <stack>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 
 #include <fast_io.h>
 #include <fast_io_device.h>
@@ -27,6 +41,7 @@
 #include <exception>
 #include <algorithm>
 #include <functional>
+#include <optional>
 
 #undef EOF
 #undef min